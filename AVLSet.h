@@ -0,0 +1,648 @@
+#ifndef DS_WET2_AVLSET_H
+#define DS_WET2_AVLSET_H
+
+#include <cmath>
+#include <iostream>
+#include "NodePool.h"
+#include "AVLTree.h"
+#include "TreeIterator.h"
+
+
+/* An ordered set of keys, balanced as an AVL tree.
+ * Unlike AVLTree, the nodes hold no info, and every node keeps the size of its subtree so the set supports
+ * rank and select queries.
+ */
+template<typename K>
+class AVLSet {
+private:
+    class Node;
+    NodePool<Node> nodes;
+    NodeIndex root;
+    int size;
+    void insertInner(const K& key, NodeIndex curr, NodeIndex parent);
+    void eraseInner(const K& key, NodeIndex curr, NodeIndex parent);
+    void rotateLeft(NodeIndex node, NodeIndex parent);
+    void rotateRight(NodeIndex node, NodeIndex parent);
+    void reBalanceSubTree(NodeIndex node, NodeIndex parent);
+    void updateNode(NodeIndex node);
+    int BalanceFactor(NodeIndex node) const;
+    int subtreeSize(NodeIndex node) const;
+    int heightOf(NodeIndex node) const;
+    int insertKeysInorderToArrayHelper(NodeIndex node, K*& array, int i) const;
+    void insertKeysInorderToArrayParallel(NodeIndex node, K* array, int num_threads) const;
+    NodeIndex buildFromSortedArrayHelper(K* array, int low, int high, int num_threads);
+
+public:
+    typedef TreeIterator<K, void, Node> Iterator;
+
+    explicit AVLSet(BlockArena* arena = nullptr) : nodes(arena), root(NIL), size(0) {};
+    ~AVLSet() = default;
+    AVLSet(const AVLSet<K>& other) = delete;
+    AVLSet<K>& operator=(const AVLSet<K>& other) = delete;
+    AVLSet(AVLSet<K>&& other) noexcept;
+    AVLSet<K>& operator=(AVLSet<K>&& other) noexcept;
+    bool isEmpty() const;
+    bool contains(const K& key) const;
+    bool insert(const K& key);
+    bool erase(const K& key);
+    int getSize() const;
+    K getNextKey(const K& key, const K& default_key) const;
+    K getPrevKey(const K& key, const K& default_key) const;
+    int rank(const K& key) const;
+    K select(int idx, const K& default_key) const;
+    int insertKeysInorderToArray(K*& array, int num_threads = 1) const;
+    void buildFromSortedArray(K*& array, int array_size, int num_threads = 1);
+    int mergeSortedArray(K*& array, int array_size, int num_threads = 1);
+    void swapSets(AVLSet<K>& set2) noexcept;
+    void clearSet();
+    Iterator begin() const;
+    Iterator rbegin() const;
+    Iterator end() const;
+    Iterator beginAt(const K& key) const;
+    Iterator rbeginAt(const K& key) const;
+    Iterator beginAtIndex(int idx) const;
+    Iterator rbeginAtIndex(int idx) const;
+};
+
+
+template<typename K>
+class AVLSet<K>::Node {
+public:
+    K key;
+    NodeIndex left;
+    NodeIndex right;
+    int subtree_size;
+    int8_t height;
+    Node() : key(), left(NIL), right(NIL), subtree_size(1), height(0) {};
+    explicit Node(const K& key) : key(key), left(NIL), right(NIL), subtree_size(1), height(0) {};
+};
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename K>
+bool AVLSet<K>::isEmpty() const {
+    return size == 0;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename K>
+int AVLSet<K>::getSize() const {
+    return size;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename K>
+int AVLSet<K>::subtreeSize(NodeIndex node) const {
+    return (node == NIL) ? 0 : nodes[node].subtree_size;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Returns the height of the node, where an empty subtree has height -1.
+ */
+template<typename K>
+int AVLSet<K>::heightOf(NodeIndex node) const {
+    return (node == NIL) ? -1 : nodes[node].height;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Updates the height and subtree size of the node from its sons.
+ */
+template<typename K>
+void AVLSet<K>::updateNode(NodeIndex node) {
+    Node& curr = nodes[node];
+    curr.height = static_cast<int8_t>(std::max(heightOf(curr.left), heightOf(curr.right)) + 1);
+    curr.subtree_size = subtreeSize(curr.left) + subtreeSize(curr.right) + 1;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename K>
+int AVLSet<K>::BalanceFactor(NodeIndex node) const {
+    return heightOf(nodes[node].left) - heightOf(nodes[node].right);
+}
+
+
+/* Complexity: time: O(log n), space: O(1)
+ */
+template<typename K>
+bool AVLSet<K>::contains(const K& key) const {
+    NodeIndex curr = root;
+    while (curr != NIL) {
+        if (nodes[curr].key == key) {
+            return true;
+        }
+        else if (nodes[curr].key > key) {
+            curr = nodes[curr].left;
+        }
+        else {
+            curr = nodes[curr].right;
+        }
+    }
+    return false;
+}
+
+
+/* Complexity: time: O(log n), space: O(1)
+ */
+template<typename K>
+K AVLSet<K>::getNextKey(const K& key, const K& default_key) const {
+    NodeIndex next_node = NIL;
+    NodeIndex curr = root;
+    while (curr != NIL) {
+        if (nodes[curr].key > key) {
+            next_node = curr;
+            curr = nodes[curr].left;
+        } else {
+            curr = nodes[curr].right;
+        }
+    }
+    if (next_node) {
+        return nodes[next_node].key;
+    }
+    return default_key;
+}
+
+
+/* Complexity: time: O(log n), space: O(1)
+ */
+template<typename K>
+K AVLSet<K>::getPrevKey(const K& key, const K& default_key) const {
+    NodeIndex prev_node = NIL;
+    NodeIndex curr = root;
+    while (curr != NIL) {
+        if (nodes[curr].key < key) {
+            prev_node = curr;
+            curr = nodes[curr].right;
+        } else {
+            curr = nodes[curr].left;
+        }
+    }
+    if (prev_node) {
+        return nodes[prev_node].key;
+    }
+    return default_key;
+}
+
+
+/* Complexity: time: O(log n), space: O(1)
+ * Returns the amount of keys in the set that are smaller than or equal to "key".
+ */
+template<typename K>
+int AVLSet<K>::rank(const K& key) const {
+    int counter = 0;
+    NodeIndex curr = root;
+    while (curr != NIL) {
+        if (nodes[curr].key > key) {
+            curr = nodes[curr].left;
+        }
+        else {
+            counter += subtreeSize(nodes[curr].left) + 1;
+            if (nodes[curr].key == key) {
+                break;
+            }
+            curr = nodes[curr].right;
+        }
+    }
+    return counter;
+}
+
+
+/* Complexity: time: O(log n), space: O(1)
+ * Returns the idx-th smallest key in the set (starting from 1), or "default_key" if idx is out of range.
+ */
+template<typename K>
+K AVLSet<K>::select(int idx, const K& default_key) const {
+    if (idx <= 0 || idx > size) {
+        return default_key;
+    }
+    NodeIndex curr = root;
+    while (curr != NIL) {
+        int left_size = subtreeSize(nodes[curr].left);
+        if (idx <= left_size) {
+            curr = nodes[curr].left;
+        }
+        else if (idx == left_size + 1) {
+            return nodes[curr].key;
+        }
+        else {
+            idx -= left_size + 1;
+            curr = nodes[curr].right;
+        }
+    }
+    return default_key;
+}
+
+
+/* Complexity: time: O(log n), space: O(log n)
+ */
+template<typename K>
+bool AVLSet<K>::insert(const K& key) {
+    if (contains(key)) {
+        return false;
+    }
+    if (root == NIL) {
+        root = nodes.allocate(Node(key));
+    }
+    else {
+        insertInner(key, root, NIL);
+    }
+    size += 1;
+    return true;
+}
+
+
+/* Complexity: time: O(log n), space: O(log n)
+ */
+template<typename K>
+void AVLSet<K>::insertInner(const K& key, NodeIndex curr, NodeIndex parent) {
+    if (nodes[curr].key > key) {
+        if (nodes[curr].left == NIL) {
+            // Add leaf as left son
+            NodeIndex newNode = nodes.allocate(Node(key));
+            nodes[curr].left = newNode;
+        }
+        else {
+            insertInner(key, nodes[curr].left, curr);
+        }
+    }
+    else {
+        if (nodes[curr].right == NIL) {
+            // Add leaf as right son
+            NodeIndex newNode = nodes.allocate(Node(key));
+            nodes[curr].right = newNode;
+        }
+        else {
+            insertInner(key, nodes[curr].right, curr);
+        }
+    }
+    updateNode(curr);
+    reBalanceSubTree(curr, parent);
+}
+
+
+/* Complexity: time: O(log n), space: O(log n)
+ */
+template<typename K>
+bool AVLSet<K>::erase(const K& key) {
+    if (!contains(key)) {
+        return false;
+    }
+    eraseInner(key, root, NIL);
+    size -= 1;
+    return true;
+}
+
+
+/* Complexity: time: O(log n), space: O(log n)
+ */
+template<typename K>
+void AVLSet<K>::eraseInner(const K& key, NodeIndex curr, NodeIndex parent) {
+    if (key == nodes[curr].key) {
+        // First and second cases: curr has at most one son, which replaces it
+        if (nodes[curr].left == NIL || nodes[curr].right == NIL) {
+            NodeIndex son = (nodes[curr].left != NIL) ? nodes[curr].left : nodes[curr].right;
+            if (parent == NIL) {
+                root = son;
+            }
+            else if (nodes[parent].left == curr) {
+                nodes[parent].left = son;
+            }
+            else {
+                nodes[parent].right = son;
+            }
+            nodes.release(curr);
+            return;
+        }
+
+        // Third case: curr has two sons. Take the key of the next node in-order, and remove that node instead
+        NodeIndex next = nodes[curr].right;
+        while (nodes[next].left != NIL) {
+            next = nodes[next].left;
+        }
+        K next_key = nodes[next].key;
+        nodes[curr].key = next_key;
+        eraseInner(next_key, nodes[curr].right, curr);
+    }
+    else if (nodes[curr].key > key) {
+        eraseInner(key, nodes[curr].left, curr);
+    }
+    else {
+        eraseInner(key, nodes[curr].right, curr);
+    }
+    updateNode(curr);
+    reBalanceSubTree(curr, parent);
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename K>
+void AVLSet<K>::reBalanceSubTree(NodeIndex node, NodeIndex parent) {
+    int balance = BalanceFactor(node);
+    if (balance == 2) {
+        if (BalanceFactor(nodes[node].left) < 0) {
+            rotateLeft(nodes[node].left, node);
+        }
+        rotateRight(node, parent);
+    }
+    else if (balance == -2) {
+        if (BalanceFactor(nodes[node].right) > 0) {
+            rotateRight(nodes[node].right, node);
+        }
+        rotateLeft(node, parent);
+    }
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename K>
+void AVLSet<K>::rotateLeft(NodeIndex node, NodeIndex parent) {
+    NodeIndex tmpParent = nodes[node].right;
+    nodes[node].right = nodes[tmpParent].left;
+    nodes[tmpParent].left = node;
+    if (parent == NIL) {
+        root = tmpParent;
+    }
+    else if (nodes[parent].left == node) {
+        nodes[parent].left = tmpParent;
+    }
+    else {
+        nodes[parent].right = tmpParent;
+    }
+    updateNode(node);
+    updateNode(tmpParent);
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename K>
+void AVLSet<K>::rotateRight(NodeIndex node, NodeIndex parent) {
+    NodeIndex tmpParent = nodes[node].left;
+    nodes[node].left = nodes[tmpParent].right;
+    nodes[tmpParent].right = node;
+    if (parent == NIL) {
+        root = tmpParent;
+    }
+    else if (nodes[parent].left == node) {
+        nodes[parent].left = tmpParent;
+    }
+    else {
+        nodes[parent].right = tmpParent;
+    }
+    updateNode(node);
+    updateNode(tmpParent);
+}
+
+
+/* Complexity: time: O(n / num_threads + log n), space: O(log n)
+ * Fills the array with the keys of the set in-order.
+ * The function assumes the array size is at least the set size.
+ */
+template<typename K>
+int AVLSet<K>::insertKeysInorderToArray(K*& array, int num_threads) const {
+    if (num_threads <= 1) {
+        return insertKeysInorderToArrayHelper(root, array, 0);
+    }
+    insertKeysInorderToArrayParallel(root, array, num_threads);
+    return size;
+}
+
+
+/* Complexity: time: O(n), space: O(1)
+ * Fills the array (from index i) with the keys of the subtree of "node" in-order.
+ */
+template<typename K>
+int AVLSet<K>::insertKeysInorderToArrayHelper(NodeIndex node, K*& array, int i) const {
+    for (Iterator it = Iterator::fromSubtree(nodes, node, false); !it.isEnd(); ++it, i++) {
+        array[i] = it.key();
+    }
+    return i;
+}
+
+
+/* Complexity: time: O(n / num_threads + log n), space: O(log n)
+ * The subtree sizes tell where every subtree starts in the array, so the left subtree is copied by a new thread
+ * while the current thread copies the right subtree. If the thread can not be started (std::system_error), the
+ * subtree is copied by the current thread alone.
+ */
+template<typename K>
+void AVLSet<K>::insertKeysInorderToArrayParallel(NodeIndex node, K* array, int num_threads) const {
+    if (node == NIL) {
+        return;
+    }
+    if (num_threads <= 1) {
+        insertKeysInorderToArrayHelper(node, array, 0);
+        return;
+    }
+    int left_size = subtreeSize(nodes[node].left);
+    std::thread left_thread;
+    try {
+        left_thread = std::thread(&AVLSet<K>::insertKeysInorderToArrayParallel, this, nodes[node].left, array,
+                                  num_threads / 2);
+    }
+    catch (const std::system_error&) {
+        insertKeysInorderToArrayHelper(node, array, 0);
+        return;
+    }
+    array[left_size] = nodes[node].key;
+    insertKeysInorderToArrayParallel(nodes[node].right, array + left_size + 1, num_threads - num_threads / 2);
+    left_thread.join();
+}
+
+
+/* Complexity: time: O(n / num_threads + log n), space: O(n)
+ * Replaces the content of the set with the keys of a sorted array (with no duplicates).
+ * The tree is built bottom-up with the middle key of each range as the root, so it is balanced.
+ * The key array[i] is placed at index i+1 of the pool, so the nodes are laid out in-order and subtrees can be
+ * built by different threads.
+ */
+template<typename K>
+void AVLSet<K>::buildFromSortedArray(K*& array, int array_size, int num_threads) {
+    nodes.allocateAll(static_cast<NodeIndex>(array_size));
+    root = buildFromSortedArrayHelper(array, 0, array_size - 1, num_threads);
+    size = array_size;
+}
+
+
+/* Complexity: time: O(n / num_threads + log n), space: O(log n)
+ * The left subtree is built by a new thread, or by the current thread if it can not be started (std::system_error).
+ */
+template<typename K>
+NodeIndex AVLSet<K>::buildFromSortedArrayHelper(K* array, int low, int high, int num_threads) {
+    if (low > high) {
+        return NIL;
+    }
+    int mid = low + (high - low) / 2;
+    NodeIndex node = static_cast<NodeIndex>(mid + 1);
+    NodeIndex left;
+    NodeIndex right;
+    std::thread left_thread;
+    if (num_threads > 1) {
+        try {
+            left_thread = std::thread([&]() {
+                left = buildFromSortedArrayHelper(array, low, mid - 1, num_threads / 2);
+            });
+        }
+        catch (const std::system_error&) {
+            num_threads = 1;
+        }
+    }
+    if (num_threads > 1) {
+        right = buildFromSortedArrayHelper(array, mid + 1, high, num_threads - num_threads / 2);
+        left_thread.join();
+    }
+    else {
+        left = buildFromSortedArrayHelper(array, low, mid - 1, 1);
+        right = buildFromSortedArrayHelper(array, mid + 1, high, 1);
+    }
+    nodes[node] = Node(array[mid]);
+    nodes[node].left = left;
+    nodes[node].right = right;
+    updateNode(node);
+    return node;
+}
+
+
+/* Complexity: time: O((n+m) / num_threads + log(n+m)), space: O(n+m)
+ * Merges the keys of a sorted array (of size m) into the set, and returns the new size of the set.
+ * The array must not contain keys that are already in the set.
+ * If an allocation fails the set is left unchanged (buildFromSortedArray swaps in the new pool only when it is full)
+ * and the exception is passed on after the temporary arrays are freed.
+ */
+template<typename K>
+int AVLSet<K>::mergeSortedArray(K*& array, int array_size, int num_threads) {
+    K* own_keys = new K[size];
+    K* merged_keys = nullptr;
+    int merged_size;
+    try {
+        insertKeysInorderToArray(own_keys, num_threads);
+        merged_keys = new K[size + array_size];
+        merged_size = mergeSortedKeysParallel(merged_keys, own_keys, size, array, array_size, num_threads);
+    }
+    catch (...) {
+        delete[] own_keys;
+        throw;
+    }
+    delete[] own_keys;
+    try {
+        buildFromSortedArray(merged_keys, merged_size, num_threads);
+    }
+    catch (...) {
+        delete[] merged_keys;
+        throw;
+    }
+    delete[] merged_keys;
+    return merged_size;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename K>
+void AVLSet<K>::swapSets(AVLSet<K>& set2) noexcept {
+    nodes.swap(set2.nodes);
+
+    NodeIndex tempRoot = this->root;
+    this->root = set2.root;
+    set2.root = tempRoot;
+
+    int tempSize = this->size;
+    this->size = set2.size;
+    set2.size = tempSize;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename K>
+void AVLSet<K>::clearSet() {
+    nodes.clear();
+    root = NIL;
+    size = 0;
+}
+
+
+/* Complexity: time: O(log n), space: O(1)
+ * Iterators over the keys in increasing order (begin) or decreasing order (rbegin), see TreeIterator.
+ * They are invalidated by any change to the tree.
+ */
+template<typename K>
+typename AVLSet<K>::Iterator AVLSet<K>::begin() const {
+    return Iterator::fromSubtree(nodes, root, false);
+}
+
+
+template<typename K>
+typename AVLSet<K>::Iterator AVLSet<K>::rbegin() const {
+    return Iterator::fromSubtree(nodes, root, true);
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename K>
+typename AVLSet<K>::Iterator AVLSet<K>::end() const {
+    return Iterator();
+}
+
+
+/* Complexity: time: O(log n), space: O(1)
+ * Starts at the smallest key >= key (beginAt), or at the largest key <= key going down (rbeginAt).
+ */
+template<typename K>
+typename AVLSet<K>::Iterator AVLSet<K>::beginAt(const K& key) const {
+    return Iterator::fromKey(nodes, root, key, false);
+}
+
+
+template<typename K>
+typename AVLSet<K>::Iterator AVLSet<K>::rbeginAt(const K& key) const {
+    return Iterator::fromKey(nodes, root, key, true);
+}
+
+
+/* Complexity: time: O(log n), space: O(1)
+ * Starts at the key of index idx (1 for the smallest key), going up (beginAtIndex) or down (rbeginAtIndex).
+ */
+template<typename K>
+typename AVLSet<K>::Iterator AVLSet<K>::beginAtIndex(int idx) const {
+    return Iterator::fromRank(nodes, root, idx, false);
+}
+
+
+template<typename K>
+typename AVLSet<K>::Iterator AVLSet<K>::rbeginAtIndex(int idx) const {
+    return Iterator::fromRank(nodes, root, idx, true);
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Takes the nodes of "other", leaving it empty.
+ */
+template<typename K>
+AVLSet<K>::AVLSet(AVLSet<K>&& other) noexcept : root(NIL), size(0) {
+    swapSets(other);
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Takes the nodes of "other". The previous nodes are released together with "other".
+ */
+template<typename K>
+AVLSet<K>& AVLSet<K>::operator=(AVLSet<K>&& other) noexcept {
+    swapSets(other);
+    return *this;
+}
+
+
+#endif //DS_WET2_AVLSET_H
@@ -1,8 +1,12 @@
 #ifndef DS_WET1_AVLTREE_H
 #define DS_WET1_AVLTREE_H
 
-#include <cmath>
 #include <iostream>
+#include <thread>
+#include <system_error>
+#include "NodePool.h"
+#include "SimdMerge.h"
+#include "TreeIterator.h"
 
 #define DEFAULT (-1)
 
@@ -11,26 +15,32 @@ template<typename K, typename T>
 class AVLTree {
 private:
     class Node;
-    Node* root;
+    NodePool<Node> nodes;
+    NodeIndex root;
     int size;
-    void insertInner(const K& key, T* info, Node* curr, Node* parent);
-    void eraseInner(const K& key, Node* curr, Node* parent);
-    void leftLeftFix(Node* node, Node* parent);
-    void leftRightFix(Node* node, Node* parent);
-    void rightLeftFix(Node* node, Node* parent);
-    void rightRightFix(Node* node, Node* parent);
-    void rotateLeft(Node* node, Node* parent);
-    void rotateRight(Node* node, Node* parent);
-    void reBalanceSubTree(Node* node, Node* parent);
-    int deleteLeavesFromRight(Node* node, Node* parent, int amount);
-    Node* completeTreeInner(int height, Node* node, const K& default_key);
-    void deAllocateAllInfoHelper(Node* node);
-    int insertKeysInorderToArrayHelper(Node* node, K*& array, int i);
-    int insertKeysInorderToTreeHelper(Node *node, K*& array, int i);
+    void insertInner(const K& key, T* info, NodeIndex curr, NodeIndex parent);
+    void eraseInner(const K& key, NodeIndex curr, NodeIndex parent);
+    void leftLeftFix(NodeIndex node, NodeIndex parent);
+    void leftRightFix(NodeIndex node, NodeIndex parent);
+    void rightLeftFix(NodeIndex node, NodeIndex parent);
+    void rightRightFix(NodeIndex node, NodeIndex parent);
+    void rotateLeft(NodeIndex node, NodeIndex parent);
+    void rotateRight(NodeIndex node, NodeIndex parent);
+    void reBalanceSubTree(NodeIndex node, NodeIndex parent);
+    void swap(NodeIndex node, NodeIndex other);
+    NodeIndex nextInSubtree(NodeIndex node) const;
+    void updateHeight(NodeIndex node);
+    int BalanceFactor(NodeIndex node) const;
 
 public:
-    AVLTree() : root(nullptr), size(0) {};
+    typedef TreeIterator<K, T, Node> Iterator;
+
+    AVLTree() : root(NIL), size(0) {};
     ~AVLTree();
+    AVLTree(const AVLTree<K,T>& other) = delete;
+    AVLTree<K,T>& operator=(const AVLTree<K,T>& other) = delete;
+    AVLTree(AVLTree<K,T>&& other) noexcept;
+    AVLTree<K,T>& operator=(AVLTree<K,T>&& other) noexcept;
     bool isEmpty() const;
     bool contains(const K& key) const;
     bool insert(const K& key, T* info);
@@ -41,31 +51,32 @@ public:
     K getRootKey() const;
     K getNextKey(const K& key, const K& default_key) const;
     K getPrevKey(const K& key, const K& default_key) const;
-    void deAllocateAllInfo();
-    void nearlyCompleteTree(int wantedSize, const K& default_key);
     int insertKeysInorderToArray(K*& array);
-    int insertKeysInorderToTree(K*& array);
-    void swapTrees(AVLTree<K,T>& tree2);
-    void clearTree(Node* node);
+    void swapTrees(AVLTree<K,T>& tree2) noexcept;
+    void clearTree();
+    Iterator begin() const;
+    Iterator rbegin() const;
+    Iterator end() const;
+    Iterator beginAt(const K& key) const;
+    Iterator rbeginAt(const K& key) const;
 };
 
 
+/* Nodes live in the tree's NodePool and refer to their sons by 32-bit indices (NIL for no son).
+ * The fields read on a descent come first, and the info pointer last.
+ */
 template<typename K, typename T>
 class AVLTree<K,T>::Node {
 public:
     K key;
+    NodeIndex left;
+    NodeIndex right;
+    int8_t height;
     T* info;
-    Node* left;
-    Node* right;
-    int height;
-    explicit Node(const K& default_key) : key(default_key), info(nullptr), left(nullptr), right(nullptr), height(0) {};
-    Node(const K& key, T* info) : key(key), info(info), left(nullptr), right(nullptr), height(0) {};
+    Node() : key(), left(NIL), right(NIL), height(0), info(nullptr) {};
+    Node(const K& key, T* info) : key(key), left(NIL), right(NIL), height(0), info(info) {};
     bool isLeaf() const;
-    void swap(Node* other);
-    Node* nextInSubtree();
-    void updateHeight();
-    int BalanceFactor() const;
-    T* getInfo() const;
+    static T* infoOf(const NodePool<Node>& nodes, T* const* infos, NodeIndex node);
 };
 
 
@@ -73,7 +84,7 @@ public:
  */
 template<typename K, typename T>
 K AVLTree<K, T>::getRootKey() const {
-    return root->key;
+    return nodes[root].key;
 }
 
 
@@ -81,7 +92,7 @@ K AVLTree<K, T>::getRootKey() const {
  */
 template<typename K, typename T>
 T *AVLTree<K, T>::getRootInfo() const {
-    return root->info;
+    return nodes[root].info;
 }
 
 
@@ -89,30 +100,30 @@ T *AVLTree<K, T>::getRootInfo() const {
  */
 template<typename K, typename T>
 K AVLTree<K, T>::getNextKey(const K& key, const K& default_key) const {
-    Node *next_node = nullptr;
-    Node *curr = root;
-    while (curr != nullptr) {
-        if (curr->key == key) {
+    NodeIndex next_node = NIL;
+    NodeIndex curr = root;
+    while (curr != NIL) {
+        if (nodes[curr].key == key) {
             break;
-        } else if (curr->key > key) {
+        } else if (nodes[curr].key > key) {
             next_node = curr;
-            curr = curr->left;
+            curr = nodes[curr].left;
         } else {
-            curr = curr->right;
+            curr = nodes[curr].right;
         }
     }
 
-    if (!curr || !curr->right) {
+    if (!curr || !nodes[curr].right) {
         if (next_node) {
-            return next_node->key;
+            return nodes[next_node].key;
         }
         return default_key;
     }
-    curr = curr->right;
-    while (curr->left) {
-        curr = curr->left;
+    curr = nodes[curr].right;
+    while (nodes[curr].left) {
+        curr = nodes[curr].left;
     }
-    return curr->key;
+    return nodes[curr].key;
 }
 
 
@@ -120,30 +131,30 @@ K AVLTree<K, T>::getNextKey(const K& key, const K& default_key) const {
  */
 template<typename K, typename T>
 K AVLTree<K, T>::getPrevKey(const K &key, const K &default_key) const {
-    Node *prev_node = nullptr;
-    Node *curr = root;
-    while (curr != nullptr) {
-        if (curr->key == key) {
+    NodeIndex prev_node = NIL;
+    NodeIndex curr = root;
+    while (curr != NIL) {
+        if (nodes[curr].key == key) {
             break;
-        } else if (curr->key > key) {
-            curr = curr->left;
+        } else if (nodes[curr].key > key) {
+            curr = nodes[curr].left;
         } else {
             prev_node = curr;
-            curr = curr->right;
+            curr = nodes[curr].right;
         }
     }
 
-    if (!curr || !curr->left) {
+    if (!curr || !nodes[curr].left) {
         if (prev_node) {
-            return prev_node->key;
+            return nodes[prev_node].key;
         }
         return default_key;
     }
-    curr = curr->left;
-    while (curr->right) {
-        curr = curr->right;
+    curr = nodes[curr].left;
+    while (nodes[curr].right) {
+        curr = nodes[curr].right;
     }
-    return curr->key;
+    return nodes[curr].key;
 }
 
 
@@ -160,21 +171,21 @@ int AVLTree<K, T>::getSize() const{
  * This action will likely defy the search property and requires re-arranging the tree.
  */
 template<typename K, typename T>
-void AVLTree<K,T>::Node::swap(Node *other) {
-    T* temp_info = this->info;
-    this->info = other->info;
-    other->info = temp_info;
+void AVLTree<K,T>::swap(NodeIndex node, NodeIndex other) {
+    T* temp_info = nodes[node].info;
+    nodes[node].info = nodes[other].info;
+    nodes[other].info = temp_info;
 
-    K temp_key = this->key;
-    this->key = other->key;
-    other->key = temp_key;
+    K temp_key = nodes[node].key;
+    nodes[node].key = nodes[other].key;
+    nodes[other].key = temp_key;
 }
 
 /* Complexity: time: O(1), space: O(1)
  */
 template<typename K, typename T>
 bool AVLTree<K,T>::Node::isLeaf() const {
-    return ( (right == nullptr) & (left == nullptr));
+    return ( (right == NIL) & (left == NIL));
 }
 
 
@@ -182,43 +193,46 @@ bool AVLTree<K,T>::Node::isLeaf() const {
  * Updates the height of the node from its right and left sons heights.
  */
 template<typename K, typename T>
-void AVLTree<K,T>::Node::updateHeight() {
-    if (isLeaf()) {
-        height = 0;
+void AVLTree<K,T>::updateHeight(NodeIndex node) {
+    Node& curr = nodes[node];
+    if (curr.isLeaf()) {
+        curr.height = 0;
     }
-    else if (right == nullptr) {
-        height = left->height + 1;
+    else if (curr.right == NIL) {
+        curr.height = nodes[curr.left].height + 1;
     }
-    else if (left == nullptr) {
-        height = right->height + 1;
+    else if (curr.left == NIL) {
+        curr.height = nodes[curr.right].height + 1;
     }
     else {
-        height = std::max(right->height, left->height) + 1;
+        curr.height = std::max(nodes[curr.right].height, nodes[curr.left].height) + 1;
     }
 }
 
 /* Complexity: time: O(1), space: O(1)
  */
 template<typename K, typename T>
-int AVLTree<K,T>::Node::BalanceFactor() const {
-    if (isLeaf()) {
+int AVLTree<K,T>::BalanceFactor(NodeIndex node) const {
+    const Node& curr = nodes[node];
+    if (curr.isLeaf()) {
         return 0;
     }
-    else if (right == nullptr) {
-        return (left->height + 1);
+    else if (curr.right == NIL) {
+        return (nodes[curr.left].height + 1);
     }
-    else if (left == nullptr) {
-        return (- (right->height + 1));
+    else if (curr.left == NIL) {
+        return (- (nodes[curr.right].height + 1));
     }
-    return (left->height - right->height);
+    return (nodes[curr.left].height - nodes[curr.right].height);
 }
 
 
 /* Complexity: time: O(1), space: O(1)
+ * The info of a node, for TreeIterator (an AVLTree keeps the infos in its nodes).
  */
 template<typename K, typename T>
-T* AVLTree<K,T>::Node::getInfo() const {
-    return this->info;
+T* AVLTree<K,T>::Node::infoOf(const NodePool<Node>& nodes, T* const*, NodeIndex node) {
+    return nodes[node].info;
 }
 
 
@@ -226,16 +240,16 @@ T* AVLTree<K,T>::Node::getInfo() const {
  */
 template<typename K, typename T>
 bool AVLTree<K,T>::contains(const K& key) const {
-    Node* curr = root;
-    while (curr != nullptr) {
-        if (curr->key == key) {
+    NodeIndex curr = root;
+    while (curr != NIL) {
+        if (nodes[curr].key == key) {
             return true;
         }
-        else if (curr->key > key) {
-            curr = curr->left;
+        else if (nodes[curr].key > key) {
+            curr = nodes[curr].left;
         }
         else {
-            curr = curr->right;
+            curr = nodes[curr].right;
         }
     }
     return false;
@@ -259,13 +273,12 @@ bool AVLTree<K,T>::insert(const K& key, T *info) {
     if (contains(key)) { // time: O(log n)
         return false;
     }
-    if (root == nullptr) {
-        Node* newNode = new Node(key, info);
-        root = newNode;
+    if (root == NIL) {
+        root = nodes.allocate(Node(key, info));
         size += 1;
         return true;
     }
-    insertInner(key, info, root, nullptr);
+    insertInner(key, info, root, NIL);
     size += 1;
     return true;
 }
@@ -274,30 +287,30 @@ bool AVLTree<K,T>::insert(const K& key, T *info) {
 /* Complexity: time: O(log n), space: O(log n)
  */
 template<typename K, typename T>
-void AVLTree<K,T>::insertInner(const K& key, T* info, AVLTree::Node *curr, AVLTree::Node *parent) {
-    if (curr->key > key) {
-        if (curr->left == nullptr) {
+void AVLTree<K,T>::insertInner(const K& key, T* info, NodeIndex curr, NodeIndex parent) {
+    if (nodes[curr].key > key) {
+        if (nodes[curr].left == NIL) {
             // Add leaf as left son
-            Node* newNode = new Node(key, info);
-            curr->left = newNode;
+            NodeIndex newNode = nodes.allocate(Node(key, info));
+            nodes[curr].left = newNode;
         }
         else {
             // Continue down to left subtree
-            insertInner(key, info, curr->left, curr);
+            insertInner(key, info, nodes[curr].left, curr);
         }
     }
     else {
-        if (curr->right == nullptr) {
+        if (nodes[curr].right == NIL) {
             // Add leaf as right son
-            Node* newNode = new Node(key, info);
-            curr->right = newNode;
+            NodeIndex newNode = nodes.allocate(Node(key, info));
+            nodes[curr].right = newNode;
         }
         else {
             // Continue down to right subtree
-            insertInner(key, info, curr->right, curr);
+            insertInner(key, info, nodes[curr].right, curr);
         }
     }
-    curr->updateHeight();
+    updateHeight(curr);
     reBalanceSubTree(curr, parent);
 }
 
@@ -309,7 +322,7 @@ bool AVLTree<K,T>::erase(const K &key) {
     if (!contains(key)) {
         return false;
     }
-    eraseInner(key, root, nullptr);
+    eraseInner(key, root, NIL);
     size -= 1;
     return true;
 }
@@ -318,81 +331,67 @@ bool AVLTree<K,T>::erase(const K &key) {
 /* Complexity: time: O(log n), space: O(log n)
  */
 template<typename K, typename T>
-void AVLTree<K,T>::eraseInner(const K &key, AVLTree::Node *curr, AVLTree::Node *parent) {
+void AVLTree<K,T>::eraseInner(const K &key, NodeIndex curr, NodeIndex parent) {
     // Found the node to remove:
-    if (key == curr->key) {
+    if (key == nodes[curr].key) {
 
         // First case: curr is a leaf
-        if (curr->isLeaf()) {
+        if (nodes[curr].isLeaf()) {
             // disconnect the node from its parent:
-            if (parent != nullptr) {
-                if (curr == parent->left) {
-                    parent->left = nullptr;
+            if (parent != NIL) {
+                if (curr == nodes[parent].left) {
+                    nodes[parent].left = NIL;
                 }
                 else {
-                    parent->right = nullptr;
+                    nodes[parent].right = NIL;
                 }
             }
             else {
                 // curr is the root and has no sons
-                root = nullptr;
+                root = NIL;
             }
-            delete curr;
+            nodes.release(curr);
             return;
         }
 
         // Second case: curr has one son
-        else if (curr->left == nullptr || curr->right == nullptr) {
+        else if (nodes[curr].left == NIL || nodes[curr].right == NIL) {
+            NodeIndex son = (nodes[curr].left != NIL) ? nodes[curr].left : nodes[curr].right;
             // disconnect the node from its parent:
-            if (parent != nullptr) {
-                if (parent->left->key == curr->key) {
+            if (parent != NIL) {
+                if (nodes[parent].left == curr) {
                     // curr is the left child of its parent
-                    if (curr->left != nullptr) {
-                        parent->left = curr->left;
-                    }
-                    else {
-                        parent->left = curr->right;
-                    }
+                    nodes[parent].left = son;
                 }
                 else {
                     // curr is the right child of its parent
-                    if (curr->left != nullptr) {
-                        parent->right = curr->left;
-                    }
-                    else {
-                        parent->right = curr->right;
-                    }
+                    nodes[parent].right = son;
                 }
             }
             else {
                 // curr is the root and has one son:
-                if (curr->left != nullptr) {
-                    root = curr->left;
-                }
-                else {
-                    root = curr->right;
-                }
+                root = son;
             }
-            delete curr;
+            nodes.release(curr);
             return;
         }
 
         // Third case: curr has two sons
         else {
-            Node* nextNode = curr->nextInSubtree();
-            curr->swap(nextNode);
-            eraseInner(key, curr->right, curr);
+            NodeIndex nextNode = nextInSubtree(curr);
+            swap(curr, nextNode);
+            eraseInner(key, nodes[curr].right, curr);
         }
     }
 
     // If the node to remove not yet found, continue searching down the tree:
-    else if (curr->key > key) {
-        eraseInner(key, curr->left, curr);
+    else if (nodes[curr].key > key) {
+        eraseInner(key, nodes[curr].left, curr);
     }
     else {
-        eraseInner(key, curr->right, curr);
+        eraseInner(key, nodes[curr].right, curr);
     }
-    curr->updateHeight();
+    updateHeight(curr);
     reBalanceSubTree(curr, parent);
 }
 
@@ -400,17 +399,17 @@ void AVLTree<K,T>::eraseInner(const K &key, AVLTree::Node *curr, AVLTree::Node *
 /* Complexity: time: O(1), space: O(1)
  */
 template<typename K, typename T>
-void AVLTree<K,T>::reBalanceSubTree(AVLTree::Node *node, AVLTree::Node *parent) {
-    if (node->BalanceFactor() == 2) {
-        if (node->left->BalanceFactor() > -1) {
+void AVLTree<K,T>::reBalanceSubTree(NodeIndex node, NodeIndex parent) {
+    if (BalanceFactor(node) == 2) {
+        if (BalanceFactor(nodes[node].left) > -1) {
             leftLeftFix(node, parent);
         }
         else {
             leftRightFix(node, parent);
         }
     }
-    else if (node->BalanceFactor() == -2) {
-        if (node->right->BalanceFactor() < 1) {
+    else if (BalanceFactor(node) == -2) {
+        if (BalanceFactor(nodes[node].right) < 1) {
             rightRightFix(node, parent);
         }
         else {
@@ -420,42 +419,42 @@ void AVLTree<K,T>::reBalanceSubTree(AVLTree::Node *node, AVLTree::Node *parent)
 }
 
 
-/* Complexity: time: O(n), space: O(log n)
+/* Complexity: time: O(1), space: O(1)
+ * All the nodes are released together with the pool.
  */
 template<typename K, typename T>
 AVLTree<K,T>::~AVLTree() {
-    clearTree(root);
-    root = nullptr;
+    clearTree();
 }
 
 
 /* Complexity: time: O(1), space: O(1)
  */
 template<typename K, typename T>
-void AVLTree<K,T>::leftLeftFix(AVLTree::Node *node, AVLTree::Node *parent) {
+void AVLTree<K,T>::leftLeftFix(NodeIndex node, NodeIndex parent) {
     rotateRight(node, parent);
 }
 
 /* Complexity: time: O(1), space: O(1)
  */
 template<typename K, typename T>
-void AVLTree<K,T>::leftRightFix(AVLTree::Node *node, AVLTree::Node *parent) {
-    rotateLeft(node->left, node);
+void AVLTree<K,T>::leftRightFix(NodeIndex node, NodeIndex parent) {
+    rotateLeft(nodes[node].left, node);
     rotateRight(node, parent);
 }
 
 /* Complexity: time: O(1), space: O(1)
  */
 template<typename K, typename T>
-void AVLTree<K,T>::rightRightFix(AVLTree::Node *node, AVLTree::Node *parent) {
+void AVLTree<K,T>::rightRightFix(NodeIndex node, NodeIndex parent) {
     rotateLeft(node, parent);
 }
 
 /* Complexity: time: O(1), space: O(1)
  */
 template<typename K, typename T>
-void AVLTree<K,T>::rightLeftFix(AVLTree::Node *node, AVLTree::Node *parent) {
-    rotateRight(node->right, node);
+void AVLTree<K,T>::rightLeftFix(NodeIndex node, NodeIndex parent) {
+    rotateRight(nodes[node].right, node);
     rotateLeft(node, parent);
 }
 
@@ -463,57 +462,57 @@ void AVLTree<K,T>::rightLeftFix(AVLTree::Node *node, AVLTree::Node *parent) {
 /* Complexity: time: O(1), space: O(1)
  */
 template<typename K, typename T>
-void AVLTree<K,T>::rotateLeft(AVLTree::Node *node, AVLTree::Node *parent) {
+void AVLTree<K,T>::rotateLeft(NodeIndex node, NodeIndex parent) {
     if (node == root) {
-        root = node->right;
-    }
-    Node* tmpParent = node->right;
-    Node* tmpSon = node->right->left;
-    node->right->left = node;
-    node->right = tmpSon;
-    if (parent != nullptr) {
-        if (parent->key > node->key) {
-            parent->left = tmpParent;
+        root = nodes[node].right;
+    }
+    NodeIndex tmpParent = nodes[node].right;
+    NodeIndex tmpSon = nodes[tmpParent].left;
+    nodes[tmpParent].left = node;
+    nodes[node].right = tmpSon;
+    if (parent != NIL) {
+        if (nodes[parent].left == node) {
+            nodes[parent].left = tmpParent;
         } else {
-            parent->right = tmpParent;
+            nodes[parent].right = tmpParent;
         }
     }
-    node->updateHeight();
-    tmpParent->updateHeight();
+    updateHeight(node);
+    updateHeight(tmpParent);
 }
 
 
 /* Complexity: time: O(1), space: O(1)
  */
 template<typename K, typename T>
-void AVLTree<K,T>::rotateRight(AVLTree::Node *node, AVLTree::Node *parent) {
+void AVLTree<K,T>::rotateRight(NodeIndex node, NodeIndex parent) {
     if (node == root) {
-        root = node->left;
-    }
-    Node* tmpParent = node->left;
-    Node* tmpSon = node->left->right;
-    node->left->right = node;
-    node->left = tmpSon;
-    if (parent != nullptr) {
-        if (parent->key > node->key) {
-            parent->left = tmpParent;
+        root = nodes[node].left;
+    }
+    NodeIndex tmpParent = nodes[node].left;
+    NodeIndex tmpSon = nodes[tmpParent].right;
+    nodes[tmpParent].right = node;
+    nodes[node].left = tmpSon;
+    if (parent != NIL) {
+        if (nodes[parent].left == node) {
+            nodes[parent].left = tmpParent;
         } else {
-            parent->right = tmpParent;
+            nodes[parent].right = tmpParent;
         }
     }
-    node->updateHeight();
-    tmpParent->updateHeight();
+    updateHeight(node);
+    updateHeight(tmpParent);
 }
 
 
 /* Complexity: time: O(log n), space: O(1)
- * Returns pointer to the nextInSubtree node in-order. If the node is last in the tree, returns nullptr.
+ * Returns the index of the next node in-order inside the subtree of "node" (assumes "node" has a right son).
  */
 template<typename K, typename T>
-typename AVLTree<K,T>::Node *AVLTree<K,T>::Node::nextInSubtree() {
-    Node* curr = this->right;
-    while (curr->left != nullptr) {
-        curr = curr->left;
+NodeIndex AVLTree<K,T>::nextInSubtree(NodeIndex node) const {
+    NodeIndex curr = nodes[node].right;
+    while (nodes[curr].left != NIL) {
+        curr = nodes[curr].left;
     }
     return curr;
 }
@@ -523,201 +522,185 @@ typename AVLTree<K,T>::Node *AVLTree<K,T>::Node::nextInSubtree() {
  */
 template<typename K, typename T>
 T *AVLTree<K,T>::find(const K& key) {
-    Node* curr = root;
-    while (curr != nullptr) {
-        if (curr->key == key) {
-            return curr->info;
+    NodeIndex curr = root;
+    while (curr != NIL) {
+        if (nodes[curr].key == key) {
+            return nodes[curr].info;
         }
-        else if (curr->key > key) {
-            curr = curr->left;
+        else if (nodes[curr].key > key) {
+            curr = nodes[curr].left;
         }
         else {
-            curr = curr->right;
+            curr = nodes[curr].right;
         }
     }
     return nullptr;
 }
 
-/* Complexity: time: O(n), space: O(log n)
- * Deletes the wanted amount of leaves in the subtree of "node" from right to left, using reversed-Inorder traversal.
- */
-template<typename K, typename T>
-int AVLTree<K,T>::deleteLeavesFromRight(AVLTree::Node* node, AVLTree::Node* parent, int amount) {
-    if (amount == 0 || node == nullptr) {
-        return amount;
-    }
-    int newAmount = deleteLeavesFromRight(node->right, node, amount);
-    if ( (newAmount > 0) & node->isLeaf()) {
-        if (parent != nullptr) {
-            // Disconnect the node from its parent:
-            if (parent->right != nullptr) {
-                // Removing from right to left: If parent has a right child, the node to be removed is right child.
-                parent->right = nullptr;
-            }
-            else {
-                parent->left = nullptr;
-            }
-            delete node;
-            this->size -= 1;
-            return newAmount - 1;
-        }
-    }
-    if (newAmount > 0) {
-        return deleteLeavesFromRight(node->left, node, newAmount);
-    }
-    return newAmount;
-}
-
-
-/* Complexity: time: O(n), space: O(log n)
+/* Complexity: time: O(n), space: O(1)
  * Fills the array with the elements of the tree in-order.
  * The function assumes the array size is at least the tree size.
  */
 template<typename K, typename T>
 int AVLTree<K, T>::insertKeysInorderToArray(K*& array) {
-    return insertKeysInorderToArrayHelper(root, array, 0);
+    int i = 0;
+    for (Iterator it = begin(); !it.isEnd(); ++it, i++) {
+        array[i] = it.key();
+    }
+    return i;
 }
 
 
-/* Complexity: time: O(n), space: O(log n)
+/* Complexity: time: O(log(size_a+size_b)), space: O(1)
+ * Returns how many keys of array_a are among the first "diagonal" keys of the merge of the two arrays.
  */
-template<typename K, typename T>
-int AVLTree<K, T>::insertKeysInorderToArrayHelper(AVLTree::Node *node, K*& array, int i) {
-    if (node == nullptr) {
-        return i;
+template<typename K>
+int mergePathSplit(const K* array_a, int size_a, const K* array_b, int size_b, int diagonal) {
+    int low = std::max(0, diagonal - size_b);
+    int high = std::min(diagonal, size_a);
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (array_b[diagonal - 1 - mid] > array_a[mid]) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
     }
-    i = insertKeysInorderToArrayHelper(node->left, array, i);
-    array[i] = node->key;
-    i++;
-    i = insertKeysInorderToArrayHelper(node->right, array, i);
-    return i;
+    return low;
 }
 
 
-/* Complexity: time: O(size_a+size_b), space: O(1)
+/* Complexity: time: O((size_a+size_b)/num_threads + log(size_a+size_b)) with num_threads threads, space: O(1)
+ * Merges two sorted arrays that have no common keys, by splitting the output between the threads along the
+ * merge path: each thread finds where its part starts in both arrays, and merges it with mergeDistinctKeys.
+ * If a thread can not be started (std::system_error), its part is merged by the calling thread.
  */
 template<typename K>
-int mergeSortedKeys(K*& mergedArray, K*& array_a, int size_a, K*& array_b, int size_b) {
-    int ia = 0, ib = 0, i = 0;
-    while ( (ia < size_a) & (ib < size_b)) {
-        if (array_b[ib] > array_a[ia]) {
-            mergedArray[i] = array_a[ia];
-            ia++;
-        }
-        else {
-            mergedArray[i] = array_b[ib];
-            if (array_a[ia] == array_b[ib]) {
-                ia++;
-            }
-            ib++;
+int mergeSortedKeysParallel(K*& mergedArray, K*& array_a, int size_a, K*& array_b, int size_b, int num_threads) {
+    int total = size_a + size_b;
+    if (num_threads <= 1 || total < num_threads) {
+        return mergeDistinctKeys(mergedArray, array_a, size_a, array_b, size_b);
+    }
+    auto mergePart = [&](int part) {
+        int begin = static_cast<int>(static_cast<long long>(total) * part / num_threads);
+        int end = static_cast<int>(static_cast<long long>(total) * (part + 1) / num_threads);
+        int begin_a = mergePathSplit(array_a, size_a, array_b, size_b, begin);
+        int end_a = mergePathSplit(array_a, size_a, array_b, size_b, end);
+        K* merged = mergedArray + begin;
+        K* part_a = array_a + begin_a;
+        K* part_b = array_b + (begin - begin_a);
+        mergeDistinctKeys(merged, part_a, end_a - begin_a, part_b, (end - end_a) - (begin - begin_a));
+    };
+    std::thread* threads = new std::thread[num_threads - 1];
+    int started = 1;
+    try {
+        for (; started < num_threads; started++) {
+            threads[started - 1] = std::thread(mergePart, started);
         }
-        i++;
     }
-    for (; ia < size_a; ia++, i++) {
-        mergedArray[i] = array_a[ia];
+    catch (const std::system_error&) {
+        // No more threads: the parts that were not started are merged by this thread
     }
-    for (; ib < size_b; ib++, i++) {
-        mergedArray[i] = array_b[ib];
+    for (int part = started; part < num_threads; part++) {
+        mergePart(part);
     }
-    return i;
+    mergePart(0);
+    for (int part = 1; part < started; part++) {
+        threads[part - 1].join();
+    }
+    delete[] threads;
+    return total;
 }
 
 
-/* Complexity: time: O(n), space: O(log n)
+/* Complexity: time: O(n log n), space: O(n)
+ * Sorts an array of distinct keys using bottom-up merge sort.
  */
-template<typename K, typename T>
-int AVLTree<K, T>::insertKeysInorderToTree(K*& array){
-    return insertKeysInorderToTreeHelper(root, array, 0);
+template<typename K>
+void sortKeys(K*& array, int size) {
+    K* buffer = new K[size];
+    K* src = array;
+    K* dst = buffer;
+    for (int width = 1; width < size; width *= 2) {
+        for (int low = 0; low < size; low += 2 * width) {
+            int mid = std::min(low + width, size);
+            int high = std::min(low + 2 * width, size);
+            K* merged = dst + low;
+            K* left = src + low;
+            K* right = src + mid;
+            mergeDistinctKeys(merged, left, mid - low, right, high - mid);
+        }
+        K* temp = src;
+        src = dst;
+        dst = temp;
+    }
+    if (src != array) {
+        for (int i = 0; i < size; i++) {
+            array[i] = src[i];
+        }
+    }
+    delete[] buffer;
 }
 
 
-/* Complexity: time: O(n), space: O(log n) assuming the complexity of getId() is O(1).
+/* Complexity: time: O(1), space: O(1)
+ * Removes all the nodes of the tree by releasing its node pool.
  */
 template<typename K, typename T>
-int AVLTree<K, T>::insertKeysInorderToTreeHelper(AVLTree::Node *node, K*& array, int i){
-    if (node == nullptr){
-        return i;
-    }
-    i = insertKeysInorderToTreeHelper(node->left, array, i);
-    node->key = array[i];
-    node->info = nullptr;
-    i++;
-    i = insertKeysInorderToTreeHelper(node->right, array, i);
-    return i;
+void AVLTree<K,T>::clearTree() {
+    nodes.clear();
+    root = NIL;
+    size = 0;
 }
 
 
-/* Complexity: time: O(n), space: O(log n)
+/* Complexity: time: O(log n), space: O(1)
+ * Iterators over the keys in increasing order (begin) or decreasing order (rbegin), see TreeIterator.
+ * They are invalidated by any change to the tree.
  */
 template<typename K, typename T>
-void AVLTree<K,T>::clearTree(AVLTree::Node* node) {
-    if (node == nullptr) {
-        return;
-    }
-    clearTree(node->left);
-    clearTree(node->right);
-    delete node;
-    size -= 1;
+typename AVLTree<K, T>::Iterator AVLTree<K, T>::begin() const {
+    return Iterator::fromSubtree(nodes, root, false);
 }
 
 
-/* Complexity: time: O(n), space: O(log n)
- * This function should be called from an empty tree, and adds nodes to get a nearly-complete tree of empty nodes.
- * Empty nodes have "default_key" as the key, and null as the info.
- */
 template<typename K, typename T>
-void AVLTree<K,T>::nearlyCompleteTree(int wantedSize, const K& default_key) {
-    int height = static_cast<int>(ceil(log2(wantedSize + 1)) - 1);
-    root = completeTreeInner(height, root, default_key);
-    size = static_cast<int>(pow(2.0, (height+1)) - 1.0);
-    this->deleteLeavesFromRight(root, nullptr, size - wantedSize);
+typename AVLTree<K, T>::Iterator AVLTree<K, T>::rbegin() const {
+    return Iterator::fromSubtree(nodes, root, true);
 }
 
 
-/* Complexity: time: O(n), space: O(log n)
- * Helper function that fill an empty tree (with no nodes) to a complete tree of empty nodes.
+/* Complexity: time: O(1), space: O(1)
  */
 template<typename K, typename T>
-typename AVLTree<K,T>::Node* AVLTree<K,T>::completeTreeInner(int height, AVLTree::Node *node, const K& default_key) {
-    Node* newNode = new Node(default_key);
-    newNode->height = height;
-    if (height == 0) {
-        return newNode;
-    }
-    newNode->left = completeTreeInner(height-1, newNode->left, default_key);
-    newNode->right = completeTreeInner(height-1, newNode->right, default_key);
-    return newNode;
+typename AVLTree<K, T>::Iterator AVLTree<K, T>::end() const {
+    return Iterator();
 }
 
-/* Complexity: time: O(n), space: O(log n)
+
+/* Complexity: time: O(log n), space: O(1)
+ * Starts at the smallest key >= key (beginAt), or at the largest key <= key going down (rbeginAt).
  */
 template<typename K, typename T>
-void AVLTree<K, T>::deAllocateAllInfo() {
-    deAllocateAllInfoHelper(root);
+typename AVLTree<K, T>::Iterator AVLTree<K, T>::beginAt(const K& key) const {
+    return Iterator::fromKey(nodes, root, key, false);
 }
 
-/* Complexity: time: O(n), space: O(log n)
- * De-allocates the info of all the nodes in the tree using postorder traversal.
- * Should only be used by the owner of the info's memory.
- */
+
 template<typename K, typename T>
-void AVLTree<K, T>::deAllocateAllInfoHelper(AVLTree::Node* node) {
-    if (node == nullptr) {
-        return;
-    }
-    deAllocateAllInfoHelper(node->left);
-    deAllocateAllInfoHelper(node->right);
-    T* info = node->info;
-    node->info = nullptr;
-    delete info;
+typename AVLTree<K, T>::Iterator AVLTree<K, T>::rbeginAt(const K& key) const {
+    return Iterator::fromKey(nodes, root, key, true);
 }
 
 
 /* Complexity: time: O(1), space: O(1)
  */
 template<typename K, typename T>
-void AVLTree<K, T>::swapTrees(AVLTree<K, T> &tree2) {
-    Node* tempRoot = this->root;
+void AVLTree<K, T>::swapTrees(AVLTree<K, T> &tree2) noexcept {
+    nodes.swap(tree2.nodes);
+
+    NodeIndex tempRoot = this->root;
     this->root = tree2.root;
     tree2.root = tempRoot;
 
@@ -727,4 +710,23 @@ void AVLTree<K, T>::swapTrees(AVLTree<K, T> &tree2) {
 }
 
 
+/* Complexity: time: O(1), space: O(1)
+ * Takes the nodes of "other", leaving it empty.
+ */
+template<typename K, typename T>
+AVLTree<K, T>::AVLTree(AVLTree<K, T>&& other) noexcept : root(NIL), size(0) {
+    swapTrees(other);
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Takes the nodes of "other". The previous nodes are released together with "other".
+ */
+template<typename K, typename T>
+AVLTree<K, T>& AVLTree<K, T>::operator=(AVLTree<K, T>&& other) noexcept {
+    swapTrees(other);
+    return *this;
+}
+
+
 #endif //DS_WET1_AVLTREE_H
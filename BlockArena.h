@@ -0,0 +1,241 @@
+#ifndef DS_WET2_BLOCKARENA_H
+#define DS_WET2_BLOCKARENA_H
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include "PageAllocator.h"
+
+/* Allocates the growable arrays of many small containers (the players pools and undo stacks of the teams) out of
+ * shared chunks, so that all of them can be released together in O(chunks) instead of one by one.
+ * Every block is rounded up to a size class: the powers of two and the sizes 1.5 * 2^k between them (the
+ * doubling arrays of 24-byte nodes fill the latter exactly). A released block goes to the free list of its class
+ * and is reused by the next block of that class, so the memory of removed players is reused, but it goes back to
+ * the system only in clear(). Blocks bigger than MAX_CLASS_BYTES get a block of their own from PageAllocator (so
+ * big pools still get huge pages), linked into a list so that clear() frees them as well.
+ * allocate and deallocate may be called by several threads at once; clear may not.
+ */
+class BlockArena {
+private:
+    static const int MIN_CLASS_BITS = 4;
+    static const int MAX_CLASS_BITS = 16;
+    static const int NUM_CLASSES = 2 * (MAX_CLASS_BITS - MIN_CLASS_BITS) + 1;
+    static const size_t MAX_CLASS_BYTES = size_t(1) << MAX_CLASS_BITS;
+    static const size_t CHUNK_BYTES = size_t(1) << 20;
+    // The headers of the chunks and of the big blocks, which keep the memory after them cache-line aligned.
+    static const size_t HEADER_BYTES = 64;
+
+    class FreeBlock {
+    public:
+        FreeBlock* next;
+    };
+
+    class Chunk {
+    public:
+        Chunk* next;
+    };
+
+    class BigBlock {
+    public:
+        BigBlock* prev;
+        BigBlock* next;
+        size_t bytes;
+    };
+
+    std::mutex lock;
+    FreeBlock* free_lists[NUM_CLASSES];
+    Chunk* chunks;
+    char* chunk_top;
+    char* chunk_end;
+    BigBlock* big_blocks;
+
+    static int sizeClass(size_t bytes);
+    static size_t classBytes(int size_class);
+    static size_t classAlignment(int size_class);
+    void* carve(int size_class);
+    void* allocateBig(size_t bytes);
+    void deallocateBig(void* block);
+
+public:
+    BlockArena();
+    ~BlockArena();
+    BlockArena(const BlockArena& other) = delete;
+    BlockArena& operator=(const BlockArena& other) = delete;
+    void* allocate(size_t bytes);
+    void deallocate(void* block, size_t bytes);
+    void clear();
+};
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+inline BlockArena::BlockArena() : chunks(nullptr), chunk_top(nullptr), chunk_end(nullptr), big_blocks(nullptr) {
+    for (int i=0; i<NUM_CLASSES; i++) {
+        free_lists[i] = nullptr;
+    }
+}
+
+
+/* Complexity: time: O(c) for c chunks and big blocks, space: O(1)
+ */
+inline BlockArena::~BlockArena() {
+    clear();
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * The smallest class whose blocks have at least "bytes" bytes (bytes <= MAX_CLASS_BYTES).
+ */
+inline int BlockArena::sizeClass(size_t bytes) {
+    if (bytes <= (size_t(1) << MIN_CLASS_BITS)) {
+        return 0;
+    }
+    // 2^k < bytes <= 2^(k+1):
+    int k = 63 - __builtin_clzll(static_cast<unsigned long long>(bytes - 1));
+    if (bytes <= (size_t(3) << (k - 1))) {
+        return 2 * (k - MIN_CLASS_BITS) + 1;
+    }
+    return 2 * (k + 1 - MIN_CLASS_BITS);
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Class 2i holds blocks of 2^(MIN_CLASS_BITS + i) bytes, and class 2i+1 blocks of 1.5 times that.
+ */
+inline size_t BlockArena::classBytes(int size_class) {
+    if (size_class % 2 == 0) {
+        return size_t(1) << (MIN_CLASS_BITS + size_class / 2);
+    }
+    return size_t(3) << (MIN_CLASS_BITS + size_class / 2 - 1);
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * The blocks of a class are aligned to the largest power of two that fits in them, up to a cache line.
+ */
+inline size_t BlockArena::classAlignment(int size_class) {
+    size_t alignment = size_t(1) << (MIN_CLASS_BITS + size_class / 2);
+    return alignment < HEADER_BYTES ? alignment : HEADER_BYTES;
+}
+
+
+/* Complexity: time: O(1), space: O(CHUNK_BYTES) when a chunk is added
+ * Cuts a new block of the class from the newest chunk, or from a new chunk if it does not fit (the rest of the
+ * old chunk is left unused). Called with the lock held.
+ */
+inline void* BlockArena::carve(int size_class) {
+    size_t bytes = classBytes(size_class);
+    size_t alignment = classAlignment(size_class);
+    char* top = chunk_top;
+    if (top) {
+        top += (alignment - reinterpret_cast<size_t>(top) % alignment) % alignment;
+    }
+    if (!top || top + bytes > chunk_end) {
+        Chunk* chunk = static_cast<Chunk*>(PageAllocator::allocate(CHUNK_BYTES, HEADER_BYTES));
+        chunk->next = chunks;
+        chunks = chunk;
+        top = reinterpret_cast<char*>(chunk) + HEADER_BYTES;
+        chunk_end = reinterpret_cast<char*>(chunk) + CHUNK_BYTES;
+    }
+    chunk_top = top + bytes;
+    return top;
+}
+
+
+/* Complexity: time: O(1), space: O(bytes)
+ */
+inline void* BlockArena::allocateBig(size_t bytes) {
+    BigBlock* block = static_cast<BigBlock*>(PageAllocator::allocate(HEADER_BYTES + bytes, HEADER_BYTES));
+    block->bytes = bytes;
+    block->prev = nullptr;
+    std::lock_guard<std::mutex> guard(lock);
+    block->next = big_blocks;
+    if (big_blocks) {
+        big_blocks->prev = block;
+    }
+    big_blocks = block;
+    return reinterpret_cast<char*>(block) + HEADER_BYTES;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+inline void BlockArena::deallocateBig(void* block) {
+    BigBlock* big = reinterpret_cast<BigBlock*>(static_cast<char*>(block) - HEADER_BYTES);
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (big->prev) {
+            big->prev->next = big->next;
+        }
+        else {
+            big_blocks = big->next;
+        }
+        if (big->next) {
+            big->next->prev = big->prev;
+        }
+    }
+    PageAllocator::deallocate(big, HEADER_BYTES + big->bytes);
+}
+
+
+/* Complexity: time: O(1), space: O(bytes)
+ * Returns a block of at least "bytes" bytes, aligned to 16 bytes (to a cache line if it has at least 64).
+ * Throws std::bad_alloc if the memory can not be allocated.
+ */
+inline void* BlockArena::allocate(size_t bytes) {
+    if (bytes > MAX_CLASS_BYTES) {
+        return allocateBig(bytes);
+    }
+    int size_class = sizeClass(bytes);
+    std::lock_guard<std::mutex> guard(lock);
+    FreeBlock* block = free_lists[size_class];
+    if (block) {
+        free_lists[size_class] = block->next;
+        return block;
+    }
+    return carve(size_class);
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * "bytes" must be the size the block was allocated with.
+ */
+inline void BlockArena::deallocate(void* block, size_t bytes) {
+    if (!block) {
+        return;
+    }
+    if (bytes > MAX_CLASS_BYTES) {
+        deallocateBig(block);
+        return;
+    }
+    int size_class = sizeClass(bytes);
+    FreeBlock* free_block = static_cast<FreeBlock*>(block);
+    std::lock_guard<std::mutex> guard(lock);
+    free_block->next = free_lists[size_class];
+    free_lists[size_class] = free_block;
+}
+
+
+/* Complexity: time: O(c) for c chunks and big blocks, space: O(1)
+ * Releases all the blocks at once (including the ones still in use).
+ */
+inline void BlockArena::clear() {
+    while (chunks) {
+        Chunk* next = chunks->next;
+        PageAllocator::deallocate(chunks, CHUNK_BYTES);
+        chunks = next;
+    }
+    while (big_blocks) {
+        BigBlock* next = big_blocks->next;
+        PageAllocator::deallocate(big_blocks, HEADER_BYTES + big_blocks->bytes);
+        big_blocks = next;
+    }
+    for (int i=0; i<NUM_CLASSES; i++) {
+        free_lists[i] = nullptr;
+    }
+    chunk_top = nullptr;
+    chunk_end = nullptr;
+}
+
+
+#endif //DS_WET2_BLOCKARENA_H
@@ -0,0 +1,124 @@
+#ifndef DS_WET2_CHANGEFEED_H
+#define DS_WET2_CHANGEFEED_H
+
+#include <atomic>
+#include <cstdint>
+
+enum struct RankEventType : uint8_t {
+    TEAM_REKEYED     = 0,  // team_id got a new strength (value), 0 if it left the ranking (no players left)
+    WINS_CHANGED     = 1,  // team_id got value more wins
+    RANGE_WINS_ADDED = 2,  // the teams ranked from team_id up to other_team_id (inclusive) got value more wins
+    TEAM_REMOVED     = 3,  // team_id was removed
+    TOP_CHANGED      = 4,  // get_highest_ranked_team now returns value
+};
+
+class RankEvent {
+public:
+    RankEventType type;
+    int team_id;
+    int other_team_id;
+    int value;
+    RankEvent() : type(RankEventType::TEAM_REKEYED), team_id(0), other_team_id(0), value(0) {};
+    RankEvent(RankEventType type, int team_id, int other_team_id, int value) :
+            type(type), team_id(team_id), other_team_id(other_team_id), value(value) {};
+};
+
+
+/* A lock-free ring buffer of RankEvents for one producer thread (which calls push) and one consumer thread
+ * (which calls drain). The producer never waits: when the buffer is full the event is dropped and counted.
+ * The producer and the consumer each own one index, a cache line apart, and publish it with a release store.
+ * The producer also keeps the last consumer index it saw, and reads the real one only when the buffer looks full,
+ * so pushes do not touch the consumer's cache line.
+ */
+class ChangeFeed {
+private:
+    static const int CACHE_LINE = 64;
+
+    RankEvent* events;
+    uint64_t mask;
+    // Written by the producer:
+    std::atomic<uint64_t> tail;
+    uint64_t cached_head;
+    std::atomic<long long> dropped;
+    char padding[CACHE_LINE];
+    // Written by the consumer:
+    std::atomic<uint64_t> head;
+
+public:
+    explicit ChangeFeed(int min_capacity);
+    ~ChangeFeed();
+    ChangeFeed(const ChangeFeed& other) = delete;
+    ChangeFeed& operator=(const ChangeFeed& other) = delete;
+    bool push(const RankEvent& event);
+    int drain(RankEvent* out, int max_events);
+    long long getDropped() const;
+};
+
+
+/* Complexity: time: O(capacity), space: O(capacity)
+ * The capacity is min_capacity rounded up to a power of two (at least 2).
+ * Throws std::bad_alloc if the memory can not be allocated.
+ */
+inline ChangeFeed::ChangeFeed(int min_capacity) : events(nullptr), mask(0), tail(0), cached_head(0), dropped(0),
+                                                  padding(), head(0) {
+    uint64_t capacity = 2;
+    while (capacity < static_cast<uint64_t>(min_capacity)) {
+        capacity *= 2;
+    }
+    events = new RankEvent[capacity];
+    mask = capacity - 1;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+inline ChangeFeed::~ChangeFeed() {
+    delete[] events;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Producer only. Returns false (and counts the event as dropped) if the buffer is full.
+ */
+inline bool ChangeFeed::push(const RankEvent& event) {
+    uint64_t curr_tail = tail.load(std::memory_order_relaxed);
+    if (curr_tail - cached_head > mask) {
+        cached_head = head.load(std::memory_order_acquire);
+        if (curr_tail - cached_head > mask) {
+            dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+    events[curr_tail & mask] = event;
+    tail.store(curr_tail + 1, std::memory_order_release);
+    return true;
+}
+
+
+/* Complexity: time: O(max_events), space: O(1)
+ * Consumer only. Moves up to max_events of the oldest events to "out", and returns their number.
+ */
+inline int ChangeFeed::drain(RankEvent* out, int max_events) {
+    if (max_events <= 0) {
+        return 0;
+    }
+    uint64_t curr_head = head.load(std::memory_order_relaxed);
+    uint64_t available = tail.load(std::memory_order_acquire) - curr_head;
+    int count = available < static_cast<uint64_t>(max_events) ? static_cast<int>(available) : max_events;
+    for (int i=0; i<count; i++) {
+        out[i] = events[(curr_head + i) & mask];
+    }
+    head.store(curr_head + count, std::memory_order_release);
+    return count;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * The amount of events dropped because the buffer was full. May be read from any thread.
+ */
+inline long long ChangeFeed::getDropped() const {
+    return dropped.load(std::memory_order_relaxed);
+}
+
+
+#endif //DS_WET2_CHANGEFEED_H
@@ -0,0 +1,105 @@
+#include "CommandReplay.h"
+#include <string>
+
+static const char *StatusTypeStr[] =
+{
+    "SUCCESS",
+    "ALLOCATION_ERROR",
+    "INVALID_INPUT",
+    "FAILURE"
+};
+
+static void print(std::ostream& out, const std::string& cmd, StatusType res)
+{
+    out << cmd << ": " << StatusTypeStr[(int) res] << std::endl;
+}
+
+static void print(std::ostream& out, const std::string& cmd, output_t<int> res)
+{
+    if (res.status() == StatusType::SUCCESS) {
+        out << cmd << ": " << StatusTypeStr[(int) res.status()] << ", " << res.ans() << std::endl;
+    } else {
+        out << cmd << ": " << StatusTypeStr[(int) res.status()] << std::endl;
+    }
+}
+
+
+/* Complexity: time: O(1) amortized (and the cost of flushing a full batch), space: O(1)
+ */
+void CommandReplay::add_to_batch(const char* name, const PlayerCommand& command, std::ostream& out) {
+    batch[batch_size] = command;
+    batch_names[batch_size] = name;
+    batch_size++;
+    if (batch_size == BATCH_CAPACITY) {
+        flush_batch(out);
+    }
+}
+
+
+/* Complexity: time: the cost of olympics_t::apply_player_commands on the batch, space: O(1)
+ * Applies the collected batch and prints the results in the order of the commands.
+ */
+void CommandReplay::flush_batch(std::ostream& out) {
+    if (batch_size == 0) {
+        return;
+    }
+    olympics.apply_player_commands(batch, batch_size, batch_results, num_threads);
+    for (int i=0; i<batch_size; i++) {
+        print(out, batch_names[i], batch_results[i]);
+    }
+    batch_size = 0;
+}
+
+
+/* Complexity: time: the same as running the commands one by one, space: O(BATCH_CAPACITY)
+ * Returns 0 if the whole log was replayed, and -1 on an unknown command or a bad input format (as main24a2.cpp).
+ */
+int CommandReplay::run(std::istream& in, std::ostream& out) {
+    int d1 = 0, d2 = 0;
+    std::string op;
+    while (in >> op)
+    {
+        if (!op.compare("add_player")) {
+            in >> d1 >> d2;
+            add_to_batch("add_player", PlayerCommand(d1, d2, true), out);
+        } else if (!op.compare("remove_newest_player")) {
+            in >> d1;
+            add_to_batch("remove_newest_player", PlayerCommand(d1, 0, false), out);
+        } else {
+            // Every other command reads or changes the global state, so the batch must be applied first
+            flush_batch(out);
+            if (!op.compare("add_team")) {
+                in >> d1;
+                print(out, op, olympics.add_team(d1));
+            } else if (!op.compare("remove_team")) {
+                in >> d1;
+                print(out, op, olympics.remove_team(d1));
+            } else if (!op.compare("play_match")) {
+                in >> d1 >> d2;
+                print(out, op, olympics.play_match(d1, d2));
+            } else if (!op.compare("num_wins_for_team")) {
+                in >> d1;
+                print(out, op, olympics.num_wins_for_team(d1));
+            } else if (!op.compare("get_highest_ranked_team")) {
+                print(out, op, olympics.get_highest_ranked_team());
+            } else if (!op.compare("unite_teams")) {
+                in >> d1 >> d2;
+                print(out, op, olympics.unite_teams(d1, d2));
+            } else if (!op.compare("play_tournament")) {
+                in >> d1 >> d2;
+                print(out, op, olympics.play_tournament(d1, d2));
+            } else {
+                out << "Unknown command: " << op << std::endl;
+                return -1;
+            }
+        }
+        // Verify no faults
+        if (in.fail()) {
+            flush_batch(out);
+            out << "Invalid input format" << std::endl;
+            return -1;
+        }
+    }
+    flush_batch(out);
+    return 0;
+}
@@ -0,0 +1,33 @@
+#ifndef DS_WET2_COMMANDREPLAY_H
+#define DS_WET2_COMMANDREPLAY_H
+
+#include <iostream>
+#include "olympics24a2.h"
+
+/* Replays a command log (in the format read by main24a2.cpp) on an olympics_t, and writes the exact output that
+ * main24a2.cpp would write.
+ * Runs of consecutive add_player / remove_newest_player commands are collected into batches and applied with
+ * olympics_t::apply_player_commands, which updates the teams in parallel. All other commands are run in order.
+ */
+class CommandReplay {
+private:
+    static const int BATCH_CAPACITY = 4096;
+
+    olympics_t& olympics;
+    int num_threads;
+    PlayerCommand batch[BATCH_CAPACITY];
+    const char* batch_names[BATCH_CAPACITY];
+    StatusType batch_results[BATCH_CAPACITY];
+    int batch_size;
+
+    void add_to_batch(const char* name, const PlayerCommand& command, std::ostream& out);
+    void flush_batch(std::ostream& out);
+
+public:
+    CommandReplay(olympics_t& olympics, int num_threads) :
+            olympics(olympics), num_threads(num_threads), batch_size(0) {};
+    int run(std::istream& in, std::ostream& out);
+};
+
+
+#endif //DS_WET2_COMMANDREPLAY_H
@@ -0,0 +1,244 @@
+#ifndef DS_WET2_DENSETABLE_H
+#define DS_WET2_DENSETABLE_H
+
+#include <cstdint>
+
+/* Maps non-negative keys to infos by indexing a paged array directly with the key, so a lookup is a single load
+ * from the page. Pages are allocated on first use and released when they become empty, and every page has a
+ * presence bitmap, so iterating over the items skips empty slots a word at a time.
+ * Only worth it when the keys are dense (e.g. assigned sequentially), see IdTable.
+ */
+template<typename T>
+class DenseTable {
+private:
+    static const int PAGE_BITS = 10;
+    static const int PAGE_SIZE = 1 << PAGE_BITS;
+    static const int PAGE_MASK = PAGE_SIZE - 1;
+    static const int WORD_BITS = 64;
+
+    class Page {
+    public:
+        T* infos[PAGE_SIZE];
+        uint64_t present[PAGE_SIZE / WORD_BITS];
+        int count;
+        Page() : infos(), present(), count(0) {};
+    };
+
+    Page** pages;
+    int num_pages;
+    int used_size;
+
+    void growDirectory(int min_pages);
+
+public:
+    DenseTable() : pages(nullptr), num_pages(0), used_size(0) {};
+    ~DenseTable();
+    DenseTable(const DenseTable<T>& other) = delete;
+    DenseTable<T>& operator=(const DenseTable<T>& other) = delete;
+    DenseTable(DenseTable<T>&& other) noexcept;
+    DenseTable<T>& operator=(DenseTable<T>&& other) noexcept;
+    void swapTables(DenseTable<T>& other) noexcept;
+    void insert(int key, T* info);
+    void erase(int key);
+    T* find(int key) const;
+    void prefetch(int key) const;
+    bool isEmpty() const;
+    int getSize() const;
+    void reserve(int max_key);
+    int insertItemsToArrays(int*& keys, T**& infos) const;
+};
+
+
+/* Complexity: time: O(n/PAGE_SIZE), space: O(1)
+ */
+template<typename T>
+DenseTable<T>::~DenseTable() {
+    for (int p=0; p<num_pages; p++) {
+        delete pages[p];
+    }
+    delete[] pages;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Takes the items of "other", leaving it empty.
+ */
+template<typename T>
+DenseTable<T>::DenseTable(DenseTable<T>&& other) noexcept : pages(nullptr), num_pages(0), used_size(0) {
+    swapTables(other);
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Takes the items of "other". The previous items are released together with "other".
+ */
+template<typename T>
+DenseTable<T>& DenseTable<T>::operator=(DenseTable<T>&& other) noexcept {
+    swapTables(other);
+    return *this;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename T>
+void DenseTable<T>::swapTables(DenseTable<T>& other) noexcept {
+    Page** temp_pages = pages;
+    pages = other.pages;
+    other.pages = temp_pages;
+
+    int temp = num_pages;
+    num_pages = other.num_pages;
+    other.num_pages = temp;
+
+    temp = used_size;
+    used_size = other.used_size;
+    other.used_size = temp;
+}
+
+
+/* Complexity: time: O(num_pages), space: O(num_pages)
+ * Grows the page directory (by doubling) so it has at least min_pages entries.
+ */
+template<typename T>
+void DenseTable<T>::growDirectory(int min_pages) {
+    int new_num_pages = num_pages > 0 ? num_pages : 1;
+    while (new_num_pages < min_pages) {
+        new_num_pages *= 2;
+    }
+    if (new_num_pages == num_pages) {
+        return;
+    }
+    Page** new_pages = new Page*[new_num_pages];
+    for (int p=0; p<new_num_pages; p++) {
+        new_pages[p] = p < num_pages ? pages[p] : nullptr;
+    }
+    delete[] pages;
+    pages = new_pages;
+    num_pages = new_num_pages;
+}
+
+
+/* Complexity: time: O(1) amortized, space: O(1) amortized
+ * The key must not be in the table.
+ */
+template<typename T>
+void DenseTable<T>::insert(int key, T* info) {
+    int p = key >> PAGE_BITS;
+    if (p >= num_pages) {
+        growDirectory(p + 1);
+    }
+    if (!pages[p]) {
+        pages[p] = new Page();
+    }
+    Page* page = pages[p];
+    int offset = key & PAGE_MASK;
+    page->infos[offset] = info;
+    page->present[offset / WORD_BITS] |= uint64_t(1) << (offset % WORD_BITS);
+    page->count++;
+    used_size++;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename T>
+void DenseTable<T>::erase(int key) {
+    int p = key >> PAGE_BITS;
+    if (key < 0 || p >= num_pages || !pages[p]) {
+        return;
+    }
+    Page* page = pages[p];
+    int offset = key & PAGE_MASK;
+    uint64_t bit = uint64_t(1) << (offset % WORD_BITS);
+    if (!(page->present[offset / WORD_BITS] & bit)) {
+        return;
+    }
+    page->infos[offset] = nullptr;
+    page->present[offset / WORD_BITS] &= ~bit;
+    page->count--;
+    used_size--;
+    if (page->count == 0) {
+        delete page;
+        pages[p] = nullptr;
+    }
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * If item was not found, returns nullptr
+ */
+template<typename T>
+T* DenseTable<T>::find(int key) const {
+    int p = key >> PAGE_BITS;
+    if (key < 0 || p >= num_pages || !pages[p]) {
+        return nullptr;
+    }
+    return pages[p]->infos[key & PAGE_MASK];
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Hints the CPU to start loading the slot of the key, for a find() that follows a bit later.
+ */
+template<typename T>
+void DenseTable<T>::prefetch(int key) const {
+    int p = key >> PAGE_BITS;
+    if (key >= 0 && p < num_pages && pages[p]) {
+        __builtin_prefetch(&pages[p]->infos[key & PAGE_MASK]);
+    }
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename T>
+bool DenseTable<T>::isEmpty() const {
+    return used_size == 0;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename T>
+int DenseTable<T>::getSize() const {
+    return used_size;
+}
+
+
+/* Complexity: time: O(max_key/PAGE_SIZE), space: O(max_key/PAGE_SIZE)
+ * Pre-sizes the page directory for keys up to max_key.
+ */
+template<typename T>
+void DenseTable<T>::reserve(int max_key) {
+    if (max_key >= 0) {
+        growDirectory((max_key >> PAGE_BITS) + 1);
+    }
+}
+
+
+/* Complexity: time: O(n + max_key/64), space: O(1)
+ * Writes the keys of all the items (in increasing order) and their infos to the arrays, and returns the amount.
+ */
+template<typename T>
+int DenseTable<T>::insertItemsToArrays(int*& keys, T**& infos) const {
+    int i = 0;
+    for (int p=0; p<num_pages; p++) {
+        if (!pages[p]) {
+            continue;
+        }
+        for (int w=0; w<PAGE_SIZE/WORD_BITS; w++) {
+            uint64_t bits = pages[p]->present[w];
+            while (bits) {
+                int offset = w * WORD_BITS + __builtin_ctzll(bits);
+                keys[i] = (p << PAGE_BITS) | offset;
+                infos[i] = pages[p]->infos[offset];
+                i++;
+                bits &= bits - 1;
+            }
+        }
+    }
+    return i;
+}
+
+#endif //DS_WET2_DENSETABLE_H
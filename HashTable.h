@@ -2,84 +2,202 @@
 #define DS_WET2_HASHTABLE_H
 
 #include "AVLTree.h"
+#include <cstdint>
 
-template<typename T>
+/* Hash policies for HashTable: each maps a key to a bucket in [0, 2^log_size).
+ * ModuloHash takes the low bits of the key (key % size), which is fine for sequential keys but puts strided keys
+ * in few buckets. FibonacciHash multiplies by 2^32 / golden ratio and takes the top bits. SeededHash mixes the key
+ * with a seed (the murmur3 finalizer), for keys that may be chosen adversarially.
+ */
+class ModuloHash {
+public:
+    uint32_t operator()(int key, int log_size) const {
+        return static_cast<uint32_t>(key) & ((uint32_t(1) << log_size) - 1);
+    }
+};
+
+class FibonacciHash {
+public:
+    uint32_t operator()(int key, int log_size) const {
+        if (log_size == 0) {
+            return 0;
+        }
+        return (static_cast<uint32_t>(key) * 2654435769u) >> (32 - log_size);
+    }
+};
+
+class SeededHash {
+private:
+    uint32_t seed;
+public:
+    explicit SeededHash(uint32_t seed = 0x9E3779B9u) : seed(seed) {};
+    uint32_t operator()(int key, int log_size) const {
+        uint32_t h = static_cast<uint32_t>(key) ^ seed;
+        h ^= h >> 16;
+        h *= 0x85EBCA6Bu;
+        h ^= h >> 13;
+        h *= 0xC2B2AE35u;
+        h ^= h >> 16;
+        return h & ((uint32_t(1) << log_size) - 1);
+    }
+};
+
+
+/* The table grows (doubles) when it has as many items as buckets, and shrinks (halves) when the load drops to
+ * shrink_load, but never below its initial size or the size set by reserve(). shrink_load must be below 0.5, so
+ * a shrink can not be followed by a grow right away.
+ */
+template<typename T, typename Hash = FibonacciHash>
 class HashTable {
 private:
+    static const int DEFAULT_INIT_SIZE = 4;
+    static constexpr double DEFAULT_SHRINK_LOAD = 0.25;
+
     int size;
+    int log_size;
     int used_size;
+    int min_size;
+    double shrink_load;
     AVLTree<int, T>* table;
-    const double MIN_LOAD = 0.25;
-    const int INIT_SIZE = 4;
+    Hash hash;
 
     void resize();
+    void rehash(int new_size);
     int hashKey(int key);
 
 public:
-    HashTable();
+    explicit HashTable(int initial_size = DEFAULT_INIT_SIZE, double shrink_load = DEFAULT_SHRINK_LOAD,
+                       const Hash& hash = Hash());
     ~HashTable();
+    HashTable(const HashTable<T, Hash>& other) = delete;
+    HashTable<T, Hash>& operator=(const HashTable<T, Hash>& other) = delete;
+    HashTable(HashTable<T, Hash>&& other) noexcept;
+    HashTable<T, Hash>& operator=(HashTable<T, Hash>&& other) noexcept;
+    void swapTables(HashTable<T, Hash>& other) noexcept;
     void insert(int key, T* info);
     void erase(int key);
     T* find(int key);
+    void prefetch(int key);
     bool isEmpty() const;
-    void deAllocateAllInfo();
+    void reserve(int expected_items);
 };
 
-/* Complexity: time: O(n), space: O(1)
+template<typename T, typename Hash>
+bool HashTable<T, Hash>::isEmpty() const {
+    return used_size ==0;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
  */
-template<typename T>
-void HashTable<T>::deAllocateAllInfo() {
-    for (int i=0; i<size; i++) {
-        table[i].deAllocateAllInfo();
+template<typename T, typename Hash>
+HashTable<T, Hash>::HashTable(int initial_size, double shrink_load, const Hash& hash) :
+        size(1), log_size(0), used_size(0), shrink_load(shrink_load), table(nullptr), hash(hash) {
+    while (size < initial_size) {
+        size *= 2;
+        log_size++;
     }
+    if (this->shrink_load >= 0.5) {
+        this->shrink_load = DEFAULT_SHRINK_LOAD;
+    }
+    min_size = size;
+    table = new AVLTree<int, T>[size];
 }
 
-template<typename T>
-bool HashTable<T>::isEmpty() const {
-    return used_size ==0;
+
+/* Complexity: time: O(n), space: O(1)
+ */
+template<typename T, typename Hash>
+HashTable<T, Hash>::~HashTable() {
+    delete[] table;
 }
 
 
 /* Complexity: time: O(1), space: O(1)
+ * Takes the buckets of "other", leaving it with no buckets (it may only be destroyed or assigned to).
  */
-template<typename T>
-HashTable<T>::HashTable() {
-    size = INIT_SIZE;
-    used_size = 0;
-    table = new AVLTree<int, T>[INIT_SIZE];
+template<typename T, typename Hash>
+HashTable<T, Hash>::HashTable(HashTable<T, Hash>&& other) noexcept :
+        size(0), log_size(0), used_size(0), min_size(0), shrink_load(DEFAULT_SHRINK_LOAD), table(nullptr), hash() {
+    swapTables(other);
 }
 
 
-/* Complexity: time: O(n), space: O(1)
+/* Complexity: time: O(1), space: O(1)
+ * Takes the buckets of "other". The previous buckets are released together with "other".
  */
-template<typename T>
-HashTable<T>::~HashTable() {
-    delete[] table;
+template<typename T, typename Hash>
+HashTable<T, Hash>& HashTable<T, Hash>::operator=(HashTable<T, Hash>&& other) noexcept {
+    swapTables(other);
+    return *this;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename T, typename Hash>
+void HashTable<T, Hash>::swapTables(HashTable<T, Hash>& other) noexcept {
+    AVLTree<int, T>* temp_table = table;
+    table = other.table;
+    other.table = temp_table;
+
+    int temp = size;
+    size = other.size;
+    other.size = temp;
+
+    temp = used_size;
+    used_size = other.used_size;
+    other.used_size = temp;
+
+    temp = log_size;
+    log_size = other.log_size;
+    other.log_size = temp;
+
+    temp = min_size;
+    min_size = other.min_size;
+    other.min_size = temp;
+
+    double temp_load = shrink_load;
+    shrink_load = other.shrink_load;
+    other.shrink_load = temp_load;
+
+    Hash temp_hash = hash;
+    hash = other.hash;
+    other.hash = temp_hash;
 }
 
 
 /* Complexity: time: O(1), space: O(1)
  */
-template<typename T>
-int HashTable<T>::hashKey(int key) {
-    return key % size;
+template<typename T, typename Hash>
+int HashTable<T, Hash>::hashKey(int key) {
+    return static_cast<int>(hash(key, log_size));
 }
 
 
 /* Complexity: time: O(1) Amortized on average, space: O(1)
  * If item was not found, returns nullptr
  */
-template<typename T>
-T* HashTable<T>::find(int key) {
+template<typename T, typename Hash>
+T* HashTable<T, Hash>::find(int key) {
     int hashed_key = hashKey(key);
     return table[hashed_key].find(key);
 }
 
 
+/* Complexity: time: O(1), space: O(1)
+ * Hints the CPU to start loading the bucket of the key, for a find() that follows a bit later.
+ */
+template<typename T, typename Hash>
+void HashTable<T, Hash>::prefetch(int key) {
+    __builtin_prefetch(table + hashKey(key));
+}
+
+
 /* Complexity: time: O(1) Amortized on average, space: O(n)
  */
-template<typename T>
-void HashTable<T>::insert(int key, T* info) {
+template<typename T, typename Hash>
+void HashTable<T, Hash>::insert(int key, T* info) {
     int hashed_key = hashKey(key);
     table[hashed_key].insert(key, info);
     used_size += 1;
@@ -89,8 +207,8 @@ void HashTable<T>::insert(int key, T* info) {
 
 /* Complexity: time: O(1) Amortized on average, space: O(1)
  */
-template<typename T>
-void HashTable<T>::erase(int key) {
+template<typename T, typename Hash>
+void HashTable<T, Hash>::erase(int key) {
     int hashed_key = hashKey(key);
     table[hashed_key].erase(key);
     used_size -= 1;
@@ -99,22 +217,48 @@ void HashTable<T>::erase(int key) {
 
 
 /* Complexity: time: O(1) Amortized on average, space: O(n)
+ * The table never shrinks below its initial size or the size set by reserve().
  */
-template<typename T>
-void HashTable<T>::resize() {
-    if ((used_size < size) && (used_size > size*MIN_LOAD || size == INIT_SIZE)) {
+template<typename T, typename Hash>
+void HashTable<T, Hash>::resize() {
+    if ((used_size < size) && (used_size > size*shrink_load || size <= min_size)) {
         return;
     }
-
-    AVLTree<int, T>* new_table;
-    int old_size = size;
     if ((used_size >= size)) {
-        size *= 2;
-        new_table = new AVLTree<int, T>[size];
+        rehash(size * 2);
     }
     else {
-        size /= 2;
-        new_table = new AVLTree<int, T>[size];
+        rehash(size / 2);
+    }
+}
+
+
+/* Complexity: time: O(n), space: O(n)
+ * Pre-sizes the table for the expected amount of items, so inserting them will not resize it.
+ */
+template<typename T, typename Hash>
+void HashTable<T, Hash>::reserve(int expected_items) {
+    int new_size = size;
+    while (new_size <= expected_items) {
+        new_size *= 2;
+    }
+    min_size = new_size;
+    if (new_size != size) {
+        rehash(new_size);
+    }
+}
+
+
+/* Complexity: time: O(n), space: O(n)
+ */
+template<typename T, typename Hash>
+void HashTable<T, Hash>::rehash(int new_size) {
+    AVLTree<int, T>* new_table = new AVLTree<int, T>[new_size];
+    int old_size = size;
+    size = new_size;
+    log_size = 0;
+    while ((1 << log_size) < size) {
+        log_size++;
     }
 
     // Move all items to the new table
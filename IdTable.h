@@ -0,0 +1,206 @@
+#ifndef DS_WET2_IDTABLE_H
+#define DS_WET2_IDTABLE_H
+
+#include "HashTable.h"
+#include "DenseTable.h"
+
+/* Maps positive ids to infos. While the ids are dense (e.g. assigned sequentially from 1) the items are kept in a
+ * DenseTable, indexed directly by the id. Once an id would make it too sparse - larger than DENSE_FACTOR times
+ * the amount of items, plus a page - all the items move to a HashTable, which is used from then on.
+ * The mode can also be fixed to the hash table with useHashTable().
+ */
+template<typename T>
+class IdTable {
+private:
+    static const int DENSE_FACTOR = 4;
+    static const int DENSE_SLACK = 1024;
+
+    bool is_dense;
+    int used_size;
+    DenseTable<T> dense;
+    HashTable<T> hash;
+
+public:
+    IdTable() : is_dense(true), used_size(0) {};
+    ~IdTable() = default;
+    IdTable(const IdTable<T>& other) = delete;
+    IdTable<T>& operator=(const IdTable<T>& other) = delete;
+    IdTable(IdTable<T>&& other) noexcept;
+    IdTable<T>& operator=(IdTable<T>&& other) noexcept;
+    void swapTables(IdTable<T>& other) noexcept;
+    void insert(int key, T* info);
+    void erase(int key);
+    T* find(int key);
+    void prefetch(int key);
+    bool isEmpty() const;
+    bool isDense() const;
+    void useHashTable();
+    void reserve(int expected_items, int max_key = -1);
+};
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Takes the items of "other", leaving it empty.
+ */
+template<typename T>
+IdTable<T>::IdTable(IdTable<T>&& other) noexcept : IdTable() {
+    swapTables(other);
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Takes the items of "other". The previous items are released together with "other".
+ */
+template<typename T>
+IdTable<T>& IdTable<T>::operator=(IdTable<T>&& other) noexcept {
+    swapTables(other);
+    return *this;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename T>
+void IdTable<T>::swapTables(IdTable<T>& other) noexcept {
+    bool temp_dense = is_dense;
+    is_dense = other.is_dense;
+    other.is_dense = temp_dense;
+
+    int temp = used_size;
+    used_size = other.used_size;
+    other.used_size = temp;
+
+    dense.swapTables(other.dense);
+    hash.swapTables(other.hash);
+}
+
+
+/* Complexity: time: O(1) Amortized on average, space: O(1) amortized
+ * (a switch to the hash table costs O(n), and happens at most once)
+ */
+template<typename T>
+void IdTable<T>::insert(int key, T* info) {
+    if (is_dense && key > DENSE_FACTOR * (used_size + 1LL) + DENSE_SLACK) {
+        useHashTable();
+    }
+    if (is_dense) {
+        dense.insert(key, info);
+    }
+    else {
+        hash.insert(key, info);
+    }
+    used_size++;
+}
+
+
+/* Complexity: time: O(1) Amortized on average, space: O(1)
+ */
+template<typename T>
+void IdTable<T>::erase(int key) {
+    if (is_dense) {
+        dense.erase(key);
+    }
+    else {
+        hash.erase(key);
+    }
+    used_size--;
+}
+
+
+/* Complexity: time: O(1) on average (a single load in the dense mode), space: O(1)
+ * If item was not found, returns nullptr
+ */
+template<typename T>
+T* IdTable<T>::find(int key) {
+    if (is_dense) {
+        return dense.find(key);
+    }
+    return hash.find(key);
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Hints the CPU to start loading where the key is looked up (the slot of a dense table, or the bucket of a hash
+ * table), so lookups of many keys can overlap their cache misses.
+ */
+template<typename T>
+void IdTable<T>::prefetch(int key) {
+    if (is_dense) {
+        dense.prefetch(key);
+    }
+    else {
+        hash.prefetch(key);
+    }
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename T>
+bool IdTable<T>::isEmpty() const {
+    return used_size == 0;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename T>
+bool IdTable<T>::isDense() const {
+    return is_dense;
+}
+
+
+/* Complexity: time: O(n) Amortized on average, space: O(n)
+ * Moves all the items to the hash table, which is used from then on.
+ */
+template<typename T>
+void IdTable<T>::useHashTable() {
+    if (!is_dense) {
+        return;
+    }
+    int* keys = new int[dense.getSize()];
+    T** infos = nullptr;
+    try {
+        infos = new T*[dense.getSize()];
+        int count = dense.insertItemsToArrays(keys, infos);
+        HashTable<T> new_hash;
+        new_hash.reserve(count);
+        for (int i=0; i<count; i++) {
+            new_hash.insert(keys[i], infos[i]);
+        }
+        hash.swapTables(new_hash);
+    }
+    catch (const std::bad_alloc&) {
+        delete[] keys;
+        delete[] infos;
+        throw;
+    }
+    delete[] keys;
+    delete[] infos;
+    dense = DenseTable<T>();
+    is_dense = false;
+}
+
+
+/* Complexity: time: O(n + expected_items) for the hash table, O(max_key/PAGE_SIZE) for the dense table,
+ * space: the same
+ * Pre-sizes the table for the expected amount of items, with ids up to max_key (expected_items if not given).
+ * If such ids would be too sparse for the dense table, switches to the hash table first.
+ */
+template<typename T>
+void IdTable<T>::reserve(int expected_items, int max_key) {
+    if (max_key < 0) {
+        max_key = expected_items;
+    }
+    if (is_dense && max_key > DENSE_FACTOR * static_cast<long long>(expected_items) + DENSE_SLACK) {
+        useHashTable();
+    }
+    if (is_dense) {
+        dense.reserve(max_key);
+    }
+    else {
+        hash.reserve(expected_items);
+    }
+}
+
+#endif //DS_WET2_IDTABLE_H
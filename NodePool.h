@@ -0,0 +1,280 @@
+#ifndef DS_WET2_NODEPOOL_H
+#define DS_WET2_NODEPOOL_H
+
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include "PageAllocator.h"
+#include "BlockArena.h"
+
+typedef uint32_t NodeIndex;
+static const NodeIndex NIL = 0;
+
+
+/* A growable pool of tree nodes addressed by 32-bit indices.
+ * Index NIL (0) is never handed out, so it can be used as the null child. Released nodes are chained
+ * into a free list through their "left" index and are reused by the next allocation.
+ * Since the pool may grow (and move its nodes), references to nodes must not be kept across allocate().
+ * The array comes from PageAllocator, so large pools can be backed by huge pages, or from a BlockArena if the
+ * pool is given one (so the arena can release it together with the arrays of many other pools).
+ */
+template<typename Node>
+class NodePool {
+private:
+    Node* nodes;
+    NodeIndex capacity;
+    NodeIndex used;
+    NodeIndex free_head;
+    NodeIndex count;
+    BlockArena* arena;
+    static const NodeIndex INIT_CAPACITY = 2;
+
+    void grow(NodeIndex new_capacity);
+    void freeNodes(Node* nodes, NodeIndex capacity) const;
+
+public:
+    explicit NodePool(BlockArena* arena = nullptr) : nodes(nullptr), capacity(0), used(0), free_head(NIL), count(0),
+                                                     arena(arena) {};
+    ~NodePool();
+    NodePool(const NodePool& other) = delete;
+    NodePool& operator=(const NodePool& other) = delete;
+    NodePool(NodePool&& other) noexcept;
+    NodePool& operator=(NodePool&& other) noexcept;
+    Node& operator[](NodeIndex idx);
+    const Node& operator[](NodeIndex idx) const;
+    void prefetch(NodeIndex idx) const;
+    void reserve(NodeIndex wanted_capacity);
+    void reserveAllocations(NodeIndex wanted_allocations);
+    NodeIndex allocate(const Node& init);
+    void allocateAll(NodeIndex wanted_count);
+    void release(NodeIndex idx);
+    void clear();
+    void swap(NodePool& other) noexcept;
+    NodeIndex getSize() const;
+    NodeIndex getCapacity() const;
+};
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename Node>
+NodePool<Node>::~NodePool() {
+    freeNodes(nodes, capacity);
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Takes the nodes of "other", leaving it empty.
+ */
+template<typename Node>
+NodePool<Node>::NodePool(NodePool<Node>&& other) noexcept : NodePool() {
+    swap(other);
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Takes the nodes of "other". The previous nodes of this pool are released together with "other".
+ */
+template<typename Node>
+NodePool<Node>& NodePool<Node>::operator=(NodePool<Node>&& other) noexcept {
+    swap(other);
+    return *this;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename Node>
+inline Node& NodePool<Node>::operator[](NodeIndex idx) {
+    return nodes[idx - 1];
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename Node>
+inline const Node& NodePool<Node>::operator[](NodeIndex idx) const {
+    return nodes[idx - 1];
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Hints the CPU to start loading the node (if it is not NIL), e.g. a son that the next step of a descent may read.
+ */
+template<typename Node>
+inline void NodePool<Node>::prefetch(NodeIndex idx) const {
+    if (idx != NIL) {
+        __builtin_prefetch(nodes + (idx - 1));
+    }
+}
+
+
+/* Complexity: time: O(n), space: O(n)
+ * Moves all nodes to a new array of the given capacity (indices are kept).
+ */
+template<typename Node>
+void NodePool<Node>::grow(NodeIndex new_capacity) {
+    static_assert(std::is_trivially_destructible<Node>::value, "the nodes are released without destructors");
+    size_t bytes = sizeof(Node) * size_t(new_capacity);
+    void* block = arena ? arena->allocate(bytes) : PageAllocator::allocate(bytes, alignof(Node));
+    Node* new_nodes = static_cast<Node*>(block);
+    for (NodeIndex i = 0; i < new_capacity; i++) {
+        new (new_nodes + i) Node();
+    }
+    for (NodeIndex i = 0; i < used; i++) {
+        new_nodes[i] = nodes[i];
+    }
+    freeNodes(nodes, capacity);
+    nodes = new_nodes;
+    capacity = new_capacity;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename Node>
+void NodePool<Node>::freeNodes(Node* nodes, NodeIndex capacity) const {
+    if (arena) {
+        arena->deallocate(nodes, sizeof(Node) * size_t(capacity));
+    }
+    else {
+        PageAllocator::deallocate(nodes, sizeof(Node) * size_t(capacity));
+    }
+}
+
+
+/* Complexity: time: O(n), space: O(wanted_capacity)
+ * Makes room for at least "wanted_capacity" nodes, so the next allocations will not move the pool.
+ */
+template<typename Node>
+void NodePool<Node>::reserve(NodeIndex wanted_capacity) {
+    if (wanted_capacity > capacity) {
+        grow(wanted_capacity);
+    }
+}
+
+
+/* Complexity: time: O(n), space: O(n)
+ * Makes sure the next "wanted_allocations" calls to allocate() will not grow the pool (so they can not throw).
+ */
+template<typename Node>
+void NodePool<Node>::reserveAllocations(NodeIndex wanted_allocations) {
+    reserve(used + wanted_allocations);
+}
+
+
+/* Complexity: time: O(1) amortized, space: O(1) amortized
+ * Returns the index of a new node initialized to "init".
+ */
+template<typename Node>
+NodeIndex NodePool<Node>::allocate(const Node& init) {
+    NodeIndex idx;
+    if (free_head != NIL) {
+        idx = free_head;
+        free_head = (*this)[idx].left;
+    }
+    else {
+        if (used == capacity) {
+            grow((capacity == 0) ? INIT_CAPACITY : capacity * 2);
+        }
+        used++;
+        idx = used;
+    }
+    (*this)[idx] = init;
+    count++;
+    return idx;
+}
+
+
+/* Complexity: time: O(n), space: O(n)
+ * Replaces the pool with exactly "wanted_count" default nodes, at the indices 1..wanted_count.
+ * Lets the caller place nodes at known indices (e.g. from several threads) without calling allocate().
+ * The new nodes are allocated before the old ones are released, so if it throws std::bad_alloc the pool is
+ * unchanged.
+ */
+template<typename Node>
+void NodePool<Node>::allocateAll(NodeIndex wanted_count) {
+    NodePool<Node> new_pool(arena);
+    if (wanted_count > 0) {
+        new_pool.grow(wanted_count);
+        new_pool.used = wanted_count;
+        new_pool.count = wanted_count;
+    }
+    swap(new_pool);
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename Node>
+void NodePool<Node>::release(NodeIndex idx) {
+    (*this)[idx].left = free_head;
+    free_head = idx;
+    count--;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Releases all the nodes at once.
+ */
+template<typename Node>
+void NodePool<Node>::clear() {
+    freeNodes(nodes, capacity);
+    nodes = nullptr;
+    capacity = 0;
+    used = 0;
+    free_head = NIL;
+    count = 0;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename Node>
+void NodePool<Node>::swap(NodePool<Node>& other) noexcept {
+    Node* temp_nodes = nodes;
+    nodes = other.nodes;
+    other.nodes = temp_nodes;
+
+    NodeIndex temp = capacity;
+    capacity = other.capacity;
+    other.capacity = temp;
+
+    temp = used;
+    used = other.used;
+    other.used = temp;
+
+    temp = free_head;
+    free_head = other.free_head;
+    other.free_head = temp;
+
+    temp = count;
+    count = other.count;
+    other.count = temp;
+
+    BlockArena* temp_arena = arena;
+    arena = other.arena;
+    other.arena = temp_arena;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Returns the number of live (allocated and not released) nodes.
+ */
+template<typename Node>
+NodeIndex NodePool<Node>::getSize() const {
+    return count;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * The number of nodes the pool has room for: allocate() does not grow it while getSize() is smaller, and the
+ * indices it hands out are at most this.
+ */
+template<typename Node>
+NodeIndex NodePool<Node>::getCapacity() const {
+    return capacity;
+}
+
+
+#endif //DS_WET2_NODEPOOL_H
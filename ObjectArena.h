@@ -0,0 +1,264 @@
+#ifndef DS_WET2_OBJECTARENA_H
+#define DS_WET2_OBJECTARENA_H
+
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/* Allocates objects in chunks of CHUNK_SIZE slots instead of one heap block per object.
+ * Destroyed objects leave their slot for the next create(): the free slots are chained through their "index"
+ * field, so destroy() never allocates (and never throws). Every chunk marks its live slots in a bitmap, so clear()
+ * finds the live objects without touching any index structure that points to them, and runs the destructor of
+ * each (O(n + chunks)). release() frees the chunks without running any destructor (O(chunks)), for objects whose
+ * own memory lives in an arena that is released with them.
+ */
+template<typename T>
+class ObjectArena {
+private:
+    static const int CHUNK_BITS = 8;
+    static const int CHUNK_SIZE = 1 << CHUNK_BITS;
+    static const int WORD_BITS = 64;
+    static const int NO_SLOT = -1;
+
+    // The object is the first member, so a pointer to it is also a pointer to its slot.
+    // "index" is the slot's own index while it is live, and the next free slot (or NO_SLOT) while it is free.
+    class Slot {
+    public:
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+        int index;
+    };
+
+    class Chunk {
+    public:
+        Slot slots[CHUNK_SIZE];
+        uint64_t live[CHUNK_SIZE / WORD_BITS];
+    };
+
+    Chunk** chunks;
+    int num_chunks;
+    int chunks_capacity;
+    int used;
+    int count;
+    int free_head;
+
+    Slot* slotAt(int index) const;
+    void addChunk();
+
+public:
+    ObjectArena() : chunks(nullptr), num_chunks(0), chunks_capacity(0), used(0), count(0), free_head(NO_SLOT) {};
+    ~ObjectArena();
+    ObjectArena(const ObjectArena<T>& other) = delete;
+    ObjectArena<T>& operator=(const ObjectArena<T>& other) = delete;
+    template<typename... Args>
+    T* create(Args&&... args);
+    void destroy(T* object) noexcept;
+    void clear();
+    void release();
+    void reserve(int wanted_count);
+    void swapArenas(ObjectArena<T>& other) noexcept;
+    int insertObjectsToArray(T**& array) const;
+    int getSize() const;
+};
+
+
+/* Complexity: time: O(c + n) for c chunks and n live objects, space: O(1)
+ */
+template<typename T>
+ObjectArena<T>::~ObjectArena() {
+    clear();
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename T>
+typename ObjectArena<T>::Slot* ObjectArena<T>::slotAt(int index) const {
+    return &chunks[index >> CHUNK_BITS]->slots[index & (CHUNK_SIZE - 1)];
+}
+
+
+/* Complexity: time: O(1) amortized, space: O(CHUNK_SIZE)
+ */
+template<typename T>
+void ObjectArena<T>::addChunk() {
+    if (num_chunks == chunks_capacity) {
+        int new_capacity = chunks_capacity == 0 ? 4 : chunks_capacity * 2;
+        Chunk** new_chunks = new Chunk*[new_capacity];
+        for (int i=0; i<num_chunks; i++) {
+            new_chunks[i] = chunks[i];
+        }
+        delete[] chunks;
+        chunks = new_chunks;
+        chunks_capacity = new_capacity;
+    }
+    chunks[num_chunks] = new Chunk();
+    num_chunks++;
+}
+
+
+/* Complexity: time: O(1) amortized and the constructor of T, space: O(1) amortized
+ * Constructs a new object in a free slot (reusing slots of destroyed objects first).
+ */
+template<typename T>
+template<typename... Args>
+T* ObjectArena<T>::create(Args&&... args) {
+    int index;
+    if (free_head != NO_SLOT) {
+        index = free_head;
+        free_head = slotAt(index)->index;
+    }
+    else {
+        if (used == num_chunks * CHUNK_SIZE) {
+            addChunk();
+        }
+        index = used;
+        used++;
+    }
+    Slot* slot = slotAt(index);
+    T* object;
+    try {
+        object = new (&slot->storage) T(std::forward<Args>(args)...);
+    }
+    catch (...) {
+        slot->index = free_head;
+        free_head = index;
+        throw;
+    }
+    slot->index = index;
+    chunks[index >> CHUNK_BITS]->live[(index & (CHUNK_SIZE - 1)) / WORD_BITS] |=
+            uint64_t(1) << (index % WORD_BITS);
+    count++;
+    return object;
+}
+
+
+/* Complexity: time: O(1) and the destructor of T (which must not throw), space: O(1)
+ * The object must have been created by this arena.
+ */
+template<typename T>
+void ObjectArena<T>::destroy(T* object) noexcept {
+    if (!object) {
+        return;
+    }
+    int index = reinterpret_cast<Slot*>(object)->index;
+    object->~T();
+    chunks[index >> CHUNK_BITS]->live[(index & (CHUNK_SIZE - 1)) / WORD_BITS] &=
+            ~(uint64_t(1) << (index % WORD_BITS));
+    count--;
+    reinterpret_cast<Slot*>(object)->index = free_head;
+    free_head = index;
+}
+
+
+/* Complexity: time: O(c + n) for c chunks and n live objects, space: O(1)
+ * Destroys all the live objects and releases all the chunks.
+ */
+template<typename T>
+void ObjectArena<T>::clear() {
+    for (int c=0; c<num_chunks; c++) {
+        for (int w=0; w<CHUNK_SIZE/WORD_BITS; w++) {
+            uint64_t bits = chunks[c]->live[w];
+            while (bits) {
+                int offset = w * WORD_BITS + __builtin_ctzll(bits);
+                reinterpret_cast<T*>(&chunks[c]->slots[offset].storage)->~T();
+                bits &= bits - 1;
+            }
+        }
+    }
+    release();
+}
+
+
+/* Complexity: time: O(c) for c chunks, space: O(1)
+ * Releases all the chunks without destroying the live objects. Only for objects that own no memory outside of an
+ * arena that is released as well (their destructors would only have returned it to that arena).
+ */
+template<typename T>
+void ObjectArena<T>::release() {
+    for (int c=0; c<num_chunks; c++) {
+        delete chunks[c];
+    }
+    delete[] chunks;
+    chunks = nullptr;
+    num_chunks = 0;
+    chunks_capacity = 0;
+    used = 0;
+    count = 0;
+    free_head = NO_SLOT;
+}
+
+
+/* Complexity: time: O(wanted_count / CHUNK_SIZE) amortized, space: O(wanted_count)
+ * Adds chunks so that the next creates, up to "wanted_count" live objects, will not need new chunks.
+ */
+template<typename T>
+void ObjectArena<T>::reserve(int wanted_count) {
+    // The free slots are the unused ones at the end, and the used - count slots of destroyed objects:
+    while (num_chunks * CHUNK_SIZE - count < wanted_count) {
+        addChunk();
+    }
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename T>
+void ObjectArena<T>::swapArenas(ObjectArena<T>& other) noexcept {
+    Chunk** temp_chunks = chunks;
+    chunks = other.chunks;
+    other.chunks = temp_chunks;
+
+    int temp = num_chunks;
+    num_chunks = other.num_chunks;
+    other.num_chunks = temp;
+
+    temp = chunks_capacity;
+    chunks_capacity = other.chunks_capacity;
+    other.chunks_capacity = temp;
+
+    temp = used;
+    used = other.used;
+    other.used = temp;
+
+    temp = count;
+    count = other.count;
+    other.count = temp;
+
+    temp = free_head;
+    free_head = other.free_head;
+    other.free_head = temp;
+}
+
+
+/* Complexity: time: O(c + n) for c chunks and n live objects, space: O(1)
+ * Fills the array with pointers to all the live objects (in the order of their slots), and returns their number.
+ */
+template<typename T>
+int ObjectArena<T>::insertObjectsToArray(T**& array) const {
+    int i = 0;
+    for (int c=0; c<num_chunks; c++) {
+        for (int w=0; w<CHUNK_SIZE/WORD_BITS; w++) {
+            uint64_t bits = chunks[c]->live[w];
+            while (bits) {
+                int offset = w * WORD_BITS + __builtin_ctzll(bits);
+                array[i] = reinterpret_cast<T*>(&chunks[c]->slots[offset].storage);
+                i++;
+                bits &= bits - 1;
+            }
+        }
+    }
+    return i;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * The number of live objects.
+ */
+template<typename T>
+int ObjectArena<T>::getSize() const {
+    return count;
+}
+
+
+#endif //DS_WET2_OBJECTARENA_H
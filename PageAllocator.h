@@ -0,0 +1,95 @@
+#ifndef DS_WET2_PAGEALLOCATOR_H
+#define DS_WET2_PAGEALLOCATOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+/* Allocates the big arrays of the node pools.
+ * Blocks of at least HUGE_PAGE_SIZE bytes are mapped directly (rounded up to whole huge pages). When huge pages
+ * are enabled with setHugePages(true), such a block is first requested from the explicit huge page pool
+ * (MAP_HUGETLB), and if none are available it is mapped normally and marked for transparent huge pages
+ * (MADV_HUGEPAGE). This cuts TLB misses on random descents through large trees.
+ * Smaller blocks (and all blocks on systems other than Linux) come from posix_memalign with the alignment of the
+ * node type, so a node type aligned to its power-of-two size (RankTree's 32-byte nodes) never straddles a cache
+ * line. Mapped blocks are page aligned.
+ */
+class PageAllocator {
+private:
+    static std::atomic<bool>& hugePagesFlag() {
+        static std::atomic<bool> enabled(false);
+        return enabled;
+    }
+
+    static size_t mappedSize(size_t bytes) {
+        return (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    }
+
+public:
+    static const size_t HUGE_PAGE_SIZE = size_t(2) << 20;
+
+    /* Complexity: time: O(1), space: O(1)*/
+    static void setHugePages(bool enabled) {
+        hugePagesFlag() = enabled;
+    }
+
+    /* Complexity: time: O(1), space: O(1)*/
+    static bool hugePagesEnabled() {
+        return hugePagesFlag();
+    }
+
+    /* Complexity: time: O(1) (the pages are zero-filled by the kernel on first touch), space: O(bytes)
+     * The block is aligned to "alignment" (a power of two, at most HUGE_PAGE_SIZE).
+     * Throws std::bad_alloc if the memory can not be allocated.*/
+    static void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+#ifdef __linux__
+        if (bytes >= HUGE_PAGE_SIZE) {
+            size_t size = mappedSize(bytes);
+            void* block = MAP_FAILED;
+            if (hugePagesEnabled()) {
+                block = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            }
+            if (block == MAP_FAILED) {
+                block = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (block == MAP_FAILED) {
+                    throw std::bad_alloc();
+                }
+                if (hugePagesEnabled()) {
+                    madvise(block, size, MADV_HUGEPAGE);
+                }
+            }
+            return block;
+        }
+#endif
+        if (alignment < sizeof(void*)) {
+            alignment = sizeof(void*);
+        }
+        void* block = nullptr;
+        if (posix_memalign(&block, alignment, bytes) != 0) {
+            throw std::bad_alloc();
+        }
+        return block;
+    }
+
+    /* Complexity: time: O(1), space: O(1)
+     * "bytes" must be the size the block was allocated with.*/
+    static void deallocate(void* block, size_t bytes) {
+        if (!block) {
+            return;
+        }
+#ifdef __linux__
+        if (bytes >= HUGE_PAGE_SIZE) {
+            munmap(block, mappedSize(bytes));
+            return;
+        }
+#endif
+        free(block);
+    }
+};
+
+
+#endif //DS_WET2_PAGEALLOCATOR_H
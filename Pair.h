@@ -1,5 +1,8 @@
 #ifndef DS_WET1_PAIR_H
 #define DS_WET1_PAIR_H
+
+#include <cstdint>
+
 #define DEFAULT (-1)
 
 class Pair {
@@ -8,30 +11,36 @@ public:
     int second;
     Pair(int first, int second) : first(first), second(second) {};
     Pair():first(DEFAULT), second(DEFAULT){};
+    Pair(const Pair& other) = default;
+
+    /* Complexity: time: O(1), space: O(1)
+     * Returns the pair as a single unsigned 64-bit key that preserves the pair ordering:
+     * "first" (biased to unsigned) in the high 32 bits, and the inverted "second" in the low 32 bits,
+     * so that every comparison between pairs is a single unsigned compare.
+     */
+    uint64_t packed() const {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(first) ^ 0x80000000u) << 32) |
+               static_cast<uint64_t>(~(static_cast<uint32_t>(second) ^ 0x80000000u));
+    }
+
     bool operator>(const Pair& other) const{
-        return (first > other.first || (first == other.first && second < other.second));
+        return packed() > other.packed();
     }
     bool operator<(const Pair& other) const{
-        return (first < other.first || (first == other.first && second > other.second));
+        return packed() < other.packed();
     }
     bool operator==(const Pair& other) const{
-        return(first == other.first && second == other.second);
-    }
-    Pair& operator=(const Pair& other) {
-        if (this != &other) {
-            first = other.first;
-            second = other.second;
-        }
-        return *this;
+        return packed() == other.packed();
     }
+    Pair& operator=(const Pair& other) = default;
     bool operator<=(const Pair& other) const{
-        return (*this < other || *this == other);
+        return packed() <= other.packed();
     }
     bool operator>=(const Pair& other) const{
-        return (*this > other || *this == other);
+        return packed() >= other.packed();
     }
     bool operator!=(const Pair& other) const{
-        return (!(*this == other));
+        return packed() != other.packed();
     }
 };
 
@@ -0,0 +1,256 @@
+#ifndef DS_WET2_RANKSNAPSHOT_H
+#define DS_WET2_RANKSNAPSHOT_H
+
+#include <new>
+#include <type_traits>
+#include "RankTree.h"
+#include "PageAllocator.h"
+
+/* A read-only copy of the keys of a RankTree, with the number of wins and the index of every key precomputed.
+ * The keys are stored in Eytzinger (BFS) order: the sons of position k are 2k and 2k+1, so a search needs no
+ * pointers and no branches - it just moves to 2k + (key[k] < key) - and the 8 keys three levels below a position
+ * share one cache line, which is prefetched on the way down.
+ * The snapshot remembers the version of the tree it was built from (see RankTree::getVersion), so isUpToDate()
+ * tells if it still matches the tree.
+ */
+template<typename K>
+class RankSnapshot {
+private:
+    static const int CACHE_LINE = 64;
+    // A prefetch of position PREFETCH_AHEAD * k brings in the descendants of k three levels down.
+    static const int PREFETCH_AHEAD = CACHE_LINE / sizeof(K) > 0 ? CACHE_LINE / sizeof(K) : 1;
+
+    // All the arrays are indexed by position (1 to size), except positions that is indexed by index.
+    K* keys;
+    int* wins;
+    int* indexes;
+    int* positions;
+    int size;
+    int capacity;
+    unsigned long long version;
+    bool valid;
+
+    void allocate(int new_capacity);
+    void release();
+    int lowerBoundPosition(const K& key) const;
+
+public:
+    RankSnapshot() : keys(nullptr), wins(nullptr), indexes(nullptr), positions(nullptr), size(0), capacity(0),
+                     version(0), valid(false) {};
+    ~RankSnapshot();
+    RankSnapshot(const RankSnapshot<K>& other) = delete;
+    RankSnapshot<K>& operator=(const RankSnapshot<K>& other) = delete;
+    template<typename T>
+    void build(const RankTree<K, T>& tree);
+    template<typename T>
+    bool isUpToDate(const RankTree<K, T>& tree) const;
+    void clear();
+    int getSize() const;
+    int get_num_wins(const K& key) const;
+    int get_index_from_key(const K& key) const;
+    int get_lower_bound_index(const K& key) const;
+    K get_key_from_index(int idx) const;
+};
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename K>
+RankSnapshot<K>::~RankSnapshot() {
+    release();
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename K>
+void RankSnapshot<K>::release() {
+    static_assert(std::is_trivially_destructible<K>::value, "the keys are released without destructing them");
+    PageAllocator::deallocate(keys, sizeof(K) * (capacity + 1));
+    delete[] wins;
+    delete[] indexes;
+    delete[] positions;
+    keys = nullptr;
+    wins = nullptr;
+    indexes = nullptr;
+    positions = nullptr;
+    capacity = 0;
+}
+
+
+/* Complexity: time: O(new_capacity), space: O(new_capacity)
+ * Replaces the arrays with empty arrays for new_capacity keys. The keys are aligned to a cache line, so every
+ * group of 8 siblings three levels below a position is in a single line.
+ */
+template<typename K>
+void RankSnapshot<K>::allocate(int new_capacity) {
+    release();
+    void* block = PageAllocator::allocate(sizeof(K) * (new_capacity + 1), CACHE_LINE);
+    keys = static_cast<K*>(block);
+    for (int i=0; i<=new_capacity; i++) {
+        new (keys + i) K();
+    }
+    capacity = new_capacity;
+    try {
+        wins = new int[new_capacity + 1];
+        indexes = new int[new_capacity + 1];
+        positions = new int[new_capacity + 1];
+    }
+    catch (const std::bad_alloc&) {
+        release();
+        throw;
+    }
+}
+
+
+/* Complexity: time: O(n), space: O(n)
+ * Copies the keys of the tree and their wins. Throws std::bad_alloc if the memory can not be allocated, leaving
+ * the snapshot empty (and not up to date).
+ */
+template<typename K>
+template<typename T>
+void RankSnapshot<K>::build(const RankTree<K, T>& tree) {
+    valid = false;
+    size = 0;
+    int n = tree.getSize();
+    if (n > capacity || n < capacity / 4) {
+        allocate(n);
+    }
+    K* sorted_keys = new K[n];
+    int* sorted_wins;
+    try {
+        sorted_wins = new int[n];
+    }
+    catch (const std::bad_alloc&) {
+        delete[] sorted_keys;
+        throw;
+    }
+    tree.insertKeysAndWinsInorderToArrays(sorted_keys, sorted_wins);
+
+    // Walk the positions in order (the in-order walk of the implicit tree), handing out the sorted keys:
+    int k = 1;
+    while (2 * k <= n) {
+        k = 2 * k;
+    }
+    for (int idx=1; idx<=n; idx++) {
+        keys[k] = sorted_keys[idx - 1];
+        wins[k] = sorted_wins[idx - 1];
+        indexes[k] = idx;
+        positions[idx] = k;
+        if (2 * k + 1 <= n) {
+            // The next position is the leftmost one in the right subtree
+            k = 2 * k + 1;
+            while (2 * k <= n) {
+                k = 2 * k;
+            }
+        }
+        else {
+            // The next position is the first ancestor whose left subtree this is
+            while (k & 1) {
+                k >>= 1;
+            }
+            k >>= 1;
+        }
+    }
+    delete[] sorted_keys;
+    delete[] sorted_wins;
+    size = n;
+    version = tree.getVersion();
+    valid = true;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename K>
+template<typename T>
+bool RankSnapshot<K>::isUpToDate(const RankTree<K, T>& tree) const {
+    return valid && version == tree.getVersion();
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Releases the arrays. The snapshot is not up to date until it is built again.
+ */
+template<typename K>
+void RankSnapshot<K>::clear() {
+    release();
+    size = 0;
+    valid = false;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename K>
+int RankSnapshot<K>::getSize() const {
+    return size;
+}
+
+
+/* Complexity: time: O(log n), space: O(1)
+ * The position of the smallest key >= key, or 0 if there is none.
+ * Every step goes to the left son (2k) or the right son (2k+1) by the comparison result, without a branch.
+ * When the walk falls off the tree, the answer is the last position where it went left: the trailing 1 bits of k
+ * are the right turns taken after it, so shifting them out (and the 0 bit of that left turn) gives it.
+ */
+template<typename K>
+int RankSnapshot<K>::lowerBoundPosition(const K& key) const {
+    int k = 1;
+    while (k <= size) {
+        __builtin_prefetch(keys + PREFETCH_AHEAD * k);
+        k = 2 * k + (keys[k] < key);
+    }
+    return k >> __builtin_ffs(~k);
+}
+
+
+/* Complexity: time: O(log n), space: O(1)
+ * Returns 0 if the key is not in the snapshot (as RankTree::get_num_wins).
+ */
+template<typename K>
+int RankSnapshot<K>::get_num_wins(const K& key) const {
+    int k = lowerBoundPosition(key);
+    if (k == 0 || keys[k] != key) {
+        return 0;
+    }
+    return wins[k];
+}
+
+
+/* Complexity: time: O(log n), space: O(1)
+ * The index of the key (1 for the smallest key), or -1 if it is not in the snapshot.
+ */
+template<typename K>
+int RankSnapshot<K>::get_index_from_key(const K& key) const {
+    int k = lowerBoundPosition(key);
+    if (k == 0 || keys[k] != key) {
+        return -1;
+    }
+    return indexes[k];
+}
+
+
+/* Complexity: time: O(log n), space: O(1)
+ * The index of the smallest key >= key, or getSize()+1 if all the keys are smaller.
+ */
+template<typename K>
+int RankSnapshot<K>::get_lower_bound_index(const K& key) const {
+    int k = lowerBoundPosition(key);
+    if (k == 0) {
+        return size + 1;
+    }
+    return indexes[k];
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * idx must be between 1 and getSize().
+ */
+template<typename K>
+K RankSnapshot<K>::get_key_from_index(int idx) const {
+    return keys[positions[idx]];
+}
+
+
+#endif //DS_WET2_RANKSNAPSHOT_H
@@ -3,6 +3,9 @@
 
 #include <cmath>
 #include <iostream>
+#include "NodePool.h"
+#include "TreeIterator.h"
+#include "AVLTree.h"
 
 #define DEFAULT (-1)
 
@@ -11,97 +14,187 @@ template<typename K, typename T>
 class RankTree {
 private:
     class Node;
-    Node* root;
+    class WinsBound;
+    NodePool<Node> nodes;
+    // The info of node i is node_infos[i - 1]: apart from the nodes, so that a descent never loads it.
+    // Grows with the pool, to the same capacity.
+    T** node_infos;
+    NodeIndex infos_capacity;
+    NodeIndex root;
     int size;
     K default_key;
-    void insertInner(const K& key, T* info, Node* curr, Node* parent);
-    void eraseInner(const K& key, Node* curr, Node* parent);
-    void leftLeftFix(Node* node, Node* parent);
-    void leftRightFix(Node* node, Node* parent);
-    void rightLeftFix(Node* node, Node* parent);
-    void rightRightFix(Node* node, Node* parent);
-    void rotateLeft(Node* node, Node* parent);
-    void rotateRight(Node* node, Node* parent);
-    void reBalanceSubTree(Node* node, Node* parent);
+    // Changes on every update of the tree (see getVersion).
+    unsigned long long version;
+    void insertInner(const K& key, T* info, NodeIndex curr, NodeIndex parent);
+    void eraseInner(const K& key, NodeIndex curr, NodeIndex parent);
+    void leftLeftFix(NodeIndex node, NodeIndex parent);
+    void leftRightFix(NodeIndex node, NodeIndex parent);
+    void rightLeftFix(NodeIndex node, NodeIndex parent);
+    void rightRightFix(NodeIndex node, NodeIndex parent);
+    void rotateLeft(NodeIndex node, NodeIndex parent);
+    void rotateRight(NodeIndex node, NodeIndex parent);
+    void reBalanceSubTree(NodeIndex node, NodeIndex parent);
+    void reserveInfos();
+    NodeIndex allocateNode(const K& key, T* info);
     void add_wins(const K& key, int x);
-    void add_wins_helper(const K& key, int x, Node* node, bool right_streak);
-    int get_index_from_key_helper(const K& key, Node* node);
+    void add_wins_helper(const K& key, int x, NodeIndex node, bool right_streak);
+    void add_wins_to_keys_helper(const K* keys, const int* wins, int low, int high, NodeIndex node);
+    void add_wins_in_ranges_helper(const WinsBound* bounds, const int* suffix_wins, int low, int high,
+                                   NodeIndex node);
+    int get_index_from_key_helper(const K& key, NodeIndex node);
+    NodeIndex buildFromSortedArrayHelper(K*& keys, T**& infos, int low, int high);
+    void swap(NodeIndex node, NodeIndex other);
+    NodeIndex nextInSubtree(NodeIndex node) const;
+    void updateHeight(NodeIndex node);
+    void updateSubtreeSize(NodeIndex node);
+    void updateMaxRank(NodeIndex node);
+    int BalanceFactor(NodeIndex node) const;
 public:
-    RankTree() : root(nullptr), size(0), default_key(K()) {};
+    typedef TreeIterator<K, T, Node> Iterator;
+
+    // A get_num_wins run one level at a time (see startNumWins), so that many of them can be interleaved.
+    class WinsLookup {
+    public:
+        K key;
+        NodeIndex node;
+        int wins;
+    };
+
+    // An update for add_wins_in_ranges: "wins" wins to every key between min_key and max_key (inclusive).
+    class RangeWins {
+    public:
+        K min_key;
+        K max_key;
+        int wins;
+        RangeWins() : min_key(), max_key(), wins(0) {};
+        RangeWins(const K& min_key, const K& max_key, int wins) : min_key(min_key), max_key(max_key), wins(wins) {};
+    };
+
+    RankTree() : node_infos(nullptr), infos_capacity(0), root(NIL), size(0), default_key(K()), version(0) {};
     ~RankTree();
+    RankTree(const RankTree<K,T>& other) = delete;
+    RankTree<K,T>& operator=(const RankTree<K,T>& other) = delete;
+    RankTree(RankTree<K,T>&& other) noexcept;
+    RankTree<K,T>& operator=(RankTree<K,T>&& other) noexcept;
+    void swapTrees(RankTree<K,T>& tree2) noexcept;
     bool isEmpty() const;
     bool contains(const K& key) const;
     bool insert(const K& key, T* info);
     bool erase(const K& key);
     T* find(const K& key);
+    void reserveInserts(int count);
     int getSize() const;
-    void clearTree(Node* node);
+    void clearTree();
     K getNextKey(const K& key) const;
     K getPrevKey(const K& key) const;
     int get_num_wins(const K& key);
+    void startNumWins(WinsLookup& lookup, const K& key) const;
+    bool stepNumWins(WinsLookup& lookup) const;
     void add_wins_in_range(const K& min_key, const K& max_key, int x);
+    void add_wins_to_keys(const K* keys, const int* wins, int count);
+    void add_wins_in_ranges(const RangeWins* updates, int count);
     int get_index_from_key(const K& key);
     K get_key_from_index(int idx);
     int get_max_rank() const;
+    void buildFromSortedArray(K*& keys, T**& infos, int array_size);
+    int insertKeysAndWinsInorderToArrays(K*& keys, int*& wins) const;
+    unsigned long long getVersion() const;
+    Iterator begin() const;
+    Iterator rbegin() const;
+    Iterator end() const;
+    Iterator beginAt(const K& key) const;
+    Iterator rbeginAt(const K& key) const;
+    Iterator beginAtIndex(int idx) const;
+    Iterator rbeginAtIndex(int idx) const;
     // TODO: delete after done testing
     void print_inorder_indexes();
-    void print_inorder_indexes_helper(Node* node);
     void print_inorder();
-    void print_inorder_helper(Node* node);
     void print_inorder_wins();
-    void print_inorder_wins_helper(Node* node);
 };
 
 
+/* Nodes live in the tree's NodePool and refer to their sons by 32-bit indices (NIL for no son).
+ * The fields read on every descent (key, sons, extra wins and subtree size) come first, then the ones only
+ * updated on the way back up. The info pointer is kept in the tree's node_infos array, so a node is 32 bytes and
+ * aligned to 32: every node lies in a single cache line, and a descent loads one line per level. The strength of a
+ * node is key.first, so updates do not have to reach the info.
+ */
 template<typename K, typename T>
-class RankTree<K,T>::Node {
+class alignas(32) RankTree<K,T>::Node {
 public:
     K key;
-    T* info;
-    Node* left;
-    Node* right;
-    int height;
+    NodeIndex left;
+    NodeIndex right;
     int extra;
     int subtree_size;
     int max_rank;
-    explicit Node(const K& default_key) : key(default_key), info(nullptr), left(nullptr), right(nullptr), height(0),
-                                          extra(0), subtree_size(1), max_rank(0) {};
-    Node(const K& key, T* info) : key(key), info(info), left(nullptr), right(nullptr), height(0), extra(0),
-                                  subtree_size(1), max_rank(info->get_strength()) {};
+    int8_t height;
+    Node() : key(), left(NIL), right(NIL), extra(0), subtree_size(1), max_rank(0), height(0) {};
+    explicit Node(const K& key) : key(key), left(NIL), right(NIL), extra(0), subtree_size(1), max_rank(key.first),
+                                  height(0) {};
     bool isLeaf() const;
-    void swap(Node* other);
-    Node* nextInSubtree();
-    void updateHeight();
-    void updateSubtreeSize();
-    void updateMaxRank();
-    int BalanceFactor() const;
-    T* getInfo() const;
+    static T* infoOf(const NodePool<Node>& nodes, T* const* infos, NodeIndex node);
 };
 
 
 /* Complexity: time: O(log n), space: O(1)
+ * Returns 0 if the key is not in the tree.
+ * A single descent (like find and the rank descents) does not prefetch: every level needs the node read just
+ * before it, and prefetching both sons only added memory traffic (see bench/descent_bench.cpp). Lookups that
+ * can overlap go through startNumWins / stepNumWins, which prefetch the son they take.
  */
 template<typename K, typename T>
 int RankTree<K, T>::get_num_wins(const K &key) {
-    if (!find(key)) {
-        return 0;
-    }
-
-    Node* curr = root;
+    NodeIndex curr = root;
     int wins = 0;
-    while (curr != nullptr) {
-        wins += curr->extra;
-        if (curr->key == key) {
+    while (curr != NIL) {
+        wins += nodes[curr].extra;
+        if (nodes[curr].key == key) {
             return wins;
         }
-        else if (curr->key > key) {
-            curr = curr->left;
+        else if (nodes[curr].key > key) {
+            curr = nodes[curr].left;
         }
         else {
-            curr = curr->right;
+            curr = nodes[curr].right;
         }
     }
-    return wins;
+    return 0;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Starts a get_num_wins of the key that is advanced by stepNumWins, and prefetches the root.
+ * Running many lookups side by side - one step of each in turn - lets the cache misses of one lookup overlap the
+ * others, instead of waiting for every miss of a single descent in a row.
+ */
+template<typename K, typename T>
+void RankTree<K, T>::startNumWins(WinsLookup& lookup, const K& key) const {
+    lookup.key = key;
+    lookup.node = root;
+    lookup.wins = 0;
+    nodes.prefetch(root);
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Goes down one level of the lookup and prefetches the next node. Returns true when the lookup is done, and then
+ * lookup.wins is the result of get_num_wins (0 if the key is not in the tree). The tree must not change meanwhile.
+ */
+template<typename K, typename T>
+bool RankTree<K, T>::stepNumWins(WinsLookup& lookup) const {
+    if (lookup.node == NIL) {
+        lookup.wins = 0;
+        return true;
+    }
+    const Node& curr = nodes[lookup.node];
+    lookup.wins += curr.extra;
+    if (curr.key == lookup.key) {
+        return true;
+    }
+    lookup.node = curr.key > lookup.key ? curr.left : curr.right;
+    nodes.prefetch(lookup.node);
+    return false;
 }
 
 
@@ -109,20 +202,21 @@ int RankTree<K, T>::get_num_wins(const K &key) {
  */
 template<typename K, typename T>
 int RankTree<K, T>::get_max_rank() const {
-    return root->max_rank;
+    return nodes[root].max_rank;
 }
 
 
 /* Complexity: time: O(1), space: O(1)
  */
 template<typename K, typename T>
-void RankTree<K, T>::Node::updateSubtreeSize() {
-    subtree_size = 1;
-    if (right) {
-        subtree_size += right->subtree_size;
+void RankTree<K, T>::updateSubtreeSize(NodeIndex node) {
+    Node& curr = nodes[node];
+    curr.subtree_size = 1;
+    if (curr.right) {
+        curr.subtree_size += nodes[curr.right].subtree_size;
     }
-    if (left) {
-        subtree_size += left->subtree_size;
+    if (curr.left) {
+        curr.subtree_size += nodes[curr.left].subtree_size;
     }
 }
 
@@ -130,13 +224,14 @@ void RankTree<K, T>::Node::updateSubtreeSize() {
 /* Complexity: time: O(1), space: O(1)
  */
 template<typename K, typename T>
-void RankTree<K, T>::Node::updateMaxRank() {
-    this->max_rank = this->info->get_strength() + this->extra;
-    if (right && this->max_rank < right->max_rank + this->extra) {
-        this->max_rank = right->max_rank + this->extra;
+void RankTree<K, T>::updateMaxRank(NodeIndex node) {
+    Node& curr = nodes[node];
+    curr.max_rank = curr.key.first + curr.extra;
+    if (curr.right && curr.max_rank < nodes[curr.right].max_rank + curr.extra) {
+        curr.max_rank = nodes[curr.right].max_rank + curr.extra;
     }
-    if (left && this->max_rank < left->max_rank + this->extra) {
-        this->max_rank = left->max_rank + this->extra;
+    if (curr.left && curr.max_rank < nodes[curr.left].max_rank + curr.extra) {
+        curr.max_rank = nodes[curr.left].max_rank + curr.extra;
     }
 }
 
@@ -145,30 +240,30 @@ void RankTree<K, T>::Node::updateMaxRank() {
  */
 template<typename K, typename T>
 K RankTree<K, T>::getPrevKey(const K &key) const {
-    Node *prev_node = nullptr;
-    Node *curr = root;
-    while (curr != nullptr) {
-        if (curr->key == key) {
+    NodeIndex prev_node = NIL;
+    NodeIndex curr = root;
+    while (curr != NIL) {
+        if (nodes[curr].key == key) {
             break;
-        } else if (curr->key > key) {
-            curr = curr->left;
+        } else if (nodes[curr].key > key) {
+            curr = nodes[curr].left;
         } else {
             prev_node = curr;
-            curr = curr->right;
+            curr = nodes[curr].right;
         }
     }
 
-    if (!curr || !curr->left) {
+    if (!curr || !nodes[curr].left) {
         if (prev_node) {
-            return prev_node->key;
+            return nodes[prev_node].key;
         }
         return default_key;
     }
-    curr = curr->left;
-    while (curr->right) {
-        curr = curr->right;
+    curr = nodes[curr].left;
+    while (nodes[curr].right) {
+        curr = nodes[curr].right;
     }
-    return curr->key;
+    return nodes[curr].key;
 }
 
 
@@ -176,30 +271,30 @@ K RankTree<K, T>::getPrevKey(const K &key) const {
  */
 template<typename K, typename T>
 K RankTree<K, T>::getNextKey(const K& key) const {
-    Node *next_node = nullptr;
-    Node *curr = root;
-    while (curr != nullptr) {
-        if (curr->key == key) {
+    NodeIndex next_node = NIL;
+    NodeIndex curr = root;
+    while (curr != NIL) {
+        if (nodes[curr].key == key) {
             break;
-        } else if (curr->key > key) {
+        } else if (nodes[curr].key > key) {
             next_node = curr;
-            curr = curr->left;
+            curr = nodes[curr].left;
         } else {
-            curr = curr->right;
+            curr = nodes[curr].right;
         }
     }
 
-    if (!curr || !curr->right) {
+    if (!curr || !nodes[curr].right) {
         if (next_node) {
-            return next_node->key;
+            return nodes[next_node].key;
         }
         return default_key;
     }
-    curr = curr->right;
-    while (curr->left) {
-        curr = curr->left;
+    curr = nodes[curr].right;
+    while (nodes[curr].left) {
+        curr = nodes[curr].left;
     }
-    return curr->key;
+    return nodes[curr].key;
 }
 
 
@@ -216,21 +311,21 @@ int RankTree<K, T>::getSize() const{
  * This action will likely defy the search property and requires re-arranging the tree.
  */
 template<typename K, typename T>
-void RankTree<K,T>::Node::swap(Node *other) {
-    T* temp_info = this->info;
-    this->info = other->info;
-    other->info = temp_info;
-
-    K temp_key = this->key;
-    this->key = other->key;
-    other->key = temp_key;
+void RankTree<K,T>::swap(NodeIndex node, NodeIndex other) {
+    T* temp_info = node_infos[node - 1];
+    node_infos[node - 1] = node_infos[other - 1];
+    node_infos[other - 1] = temp_info;
+
+    K temp_key = nodes[node].key;
+    nodes[node].key = nodes[other].key;
+    nodes[other].key = temp_key;
 }
 
 /* Complexity: time: O(1), space: O(1)
  */
 template<typename K, typename T>
 bool RankTree<K,T>::Node::isLeaf() const {
-    return ( (right == nullptr) & (left == nullptr));
+    return ( (right == NIL) & (left == NIL));
 }
 
 
@@ -238,43 +333,46 @@ bool RankTree<K,T>::Node::isLeaf() const {
  * Updates the height of the node from its right and left sons heights.
  */
 template<typename K, typename T>
-void RankTree<K,T>::Node::updateHeight() {
-    if (isLeaf()) {
-        height = 0;
+void RankTree<K,T>::updateHeight(NodeIndex node) {
+    Node& curr = nodes[node];
+    if (curr.isLeaf()) {
+        curr.height = 0;
     }
-    else if (right == nullptr) {
-        height = left->height + 1;
+    else if (curr.right == NIL) {
+        curr.height = nodes[curr.left].height + 1;
     }
-    else if (left == nullptr) {
-        height = right->height + 1;
+    else if (curr.left == NIL) {
+        curr.height = nodes[curr.right].height + 1;
     }
     else {
-        height = std::max(right->height, left->height) + 1;
+        curr.height = std::max(nodes[curr.right].height, nodes[curr.left].height) + 1;
     }
 }
 
 /* Complexity: time: O(1), space: O(1)
  */
 template<typename K, typename T>
-int RankTree<K,T>::Node::BalanceFactor() const {
-    if (isLeaf()) {
+int RankTree<K,T>::BalanceFactor(NodeIndex node) const {
+    const Node& curr = nodes[node];
+    if (curr.isLeaf()) {
         return 0;
     }
-    else if (right == nullptr) {
-        return (left->height + 1);
+    else if (curr.right == NIL) {
+        return (nodes[curr.left].height + 1);
     }
-    else if (left == nullptr) {
-        return (- (right->height + 1));
+    else if (curr.left == NIL) {
+        return (- (nodes[curr.right].height + 1));
     }
-    return (left->height - right->height);
+    return (nodes[curr.left].height - nodes[curr.right].height);
 }
 
 
 /* Complexity: time: O(1), space: O(1)
+ * The info of a node, for TreeIterator (the infos of a RankTree are not in its nodes).
  */
 template<typename K, typename T>
-T* RankTree<K,T>::Node::getInfo() const {
-    return this->info;
+T* RankTree<K,T>::Node::infoOf(const NodePool<Node>&, T* const* infos, NodeIndex node) {
+    return infos[node - 1];
 }
 
 
@@ -282,16 +380,16 @@ T* RankTree<K,T>::Node::getInfo() const {
  */
 template<typename K, typename T>
 bool RankTree<K,T>::contains(const K& key) const {
-    Node* curr = root;
-    while (curr != nullptr) {
-        if (curr->key == key) {
+    NodeIndex curr = root;
+    while (curr != NIL) {
+        if (nodes[curr].key == key) {
             return true;
         }
-        else if (curr->key > key) {
-            curr = curr->left;
+        else if (nodes[curr].key > key) {
+            curr = nodes[curr].left;
         }
         else {
-            curr = curr->right;
+            curr = nodes[curr].right;
         }
     }
     return false;
@@ -308,6 +406,48 @@ bool RankTree<K,T>::isEmpty() const {
     return false;
 }
 
+/* Complexity: time: O(n), space: O(n + count)
+ * Makes room for "count" more nodes, so the next "count" inserts will not allocate (and can not throw).
+ */
+template<typename K, typename T>
+void RankTree<K,T>::reserveInserts(int count) {
+    nodes.reserveAllocations(count);
+    reserveInfos();
+}
+
+
+/* Complexity: time: O(n) if the pool has grown, else O(1), space: O(n)
+ * Grows node_infos to the capacity of the pool.
+ */
+template<typename K, typename T>
+void RankTree<K,T>::reserveInfos() {
+    NodeIndex wanted_capacity = nodes.getCapacity();
+    if (wanted_capacity <= infos_capacity) {
+        return;
+    }
+    T** new_infos = new T*[wanted_capacity];
+    for (NodeIndex i = 0; i < infos_capacity; i++) {
+        new_infos[i] = node_infos[i];
+    }
+    delete[] node_infos;
+    node_infos = new_infos;
+    infos_capacity = wanted_capacity;
+}
+
+
+/* Complexity: time: O(1) amortized, space: O(1) amortized
+ * Returns a new node with the key and info. Everything is allocated before the node is taken, so if it throws
+ * std::bad_alloc the tree is unchanged.
+ */
+template<typename K, typename T>
+NodeIndex RankTree<K,T>::allocateNode(const K& key, T* info) {
+    nodes.reserveAllocations(1);
+    reserveInfos();
+    NodeIndex node = nodes.allocate(Node(key));
+    node_infos[node - 1] = info;
+    return node;
+}
+
 /* Complexity: time: O(log n), space: O(log n)
  */
 template<typename K, typename T>
@@ -315,13 +455,13 @@ bool RankTree<K,T>::insert(const K& key, T *info) {
     if (contains(key)) { // time: O(log n)
         return false;
     }
-    if (root == nullptr) {
-        Node* newNode = new Node(key, info);
-        root = newNode;
+    version++;
+    if (root == NIL) {
+        root = allocateNode(key, info);
         size += 1;
         return true;
     }
-    insertInner(key, info, root, nullptr);
+    insertInner(key, info, root, NIL);
     size += 1;
     return true;
 }
@@ -330,41 +470,41 @@ bool RankTree<K,T>::insert(const K& key, T *info) {
 /* Complexity: time: O(log n), space: O(log n)
  */
 template<typename K, typename T>
-void RankTree<K,T>::insertInner(const K& key, T* info, RankTree::Node *curr, RankTree::Node *parent) {
-    if (curr->key > key) {
-        if (curr->left == nullptr) {
+void RankTree<K,T>::insertInner(const K& key, T* info, NodeIndex curr, NodeIndex parent) {
+    if (nodes[curr].key > key) {
+        if (nodes[curr].left == NIL) {
             // Add leaf as left son
-            Node* newNode = new Node(key, info);
-            curr->left = newNode;
+            NodeIndex newNode = allocateNode(key, info);
+            nodes[curr].left = newNode;
             // Update "extra" and "max_rank" in the new node:
-            int sum_extra = get_num_wins(curr->key); // sum of extra values in path to the new node
-            newNode->extra -= sum_extra;
-            newNode->max_rank += newNode->extra;
+            int sum_extra = get_num_wins(nodes[curr].key); // sum of extra values in path to the new node
+            nodes[newNode].extra -= sum_extra;
+            nodes[newNode].max_rank += nodes[newNode].extra;
 
         }
         else {
             // Continue down to left subtree
-            insertInner(key, info, curr->left, curr);
+            insertInner(key, info, nodes[curr].left, curr);
         }
     }
     else {
-        if (curr->right == nullptr) {
+        if (nodes[curr].right == NIL) {
             // Add leaf as right son
-            Node* newNode = new Node(key, info);
-            curr->right = newNode;
+            NodeIndex newNode = allocateNode(key, info);
+            nodes[curr].right = newNode;
             // Update "extra" and "max_rank" in the new node:
-            int sum_extra = get_num_wins(curr->key); // sum of extra values in path to the new node
-            newNode->extra -= sum_extra;
-            newNode->max_rank += newNode->extra;
+            int sum_extra = get_num_wins(nodes[curr].key); // sum of extra values in path to the new node
+            nodes[newNode].extra -= sum_extra;
+            nodes[newNode].max_rank += nodes[newNode].extra;
         }
         else {
             // Continue down to right subtree
-            insertInner(key, info, curr->right, curr);
+            insertInner(key, info, nodes[curr].right, curr);
         }
     }
-    curr->updateHeight();
-    curr->updateSubtreeSize();
-    curr->updateMaxRank();
+    updateHeight(curr);
+    updateSubtreeSize(curr);
+    updateMaxRank(curr);
     reBalanceSubTree(curr, parent);
 }
 
@@ -376,7 +516,8 @@ bool RankTree<K,T>::erase(const K &key) {
     if (!contains(key)) {
         return false;
     }
-    eraseInner(key, root, nullptr);
+    version++;
+    eraseInner(key, root, NIL);
     size -= 1;
     return true;
 }
@@ -385,109 +526,91 @@ bool RankTree<K,T>::erase(const K &key) {
 /* Complexity: time: O(log n), space: O(log n)
  */
 template<typename K, typename T>
-void RankTree<K,T>::eraseInner(const K &key, RankTree::Node *curr, RankTree::Node *parent) {
+void RankTree<K,T>::eraseInner(const K &key, NodeIndex curr, NodeIndex parent) {
     // Found the node to remove:
-    if (key == curr->key) {
+    if (key == nodes[curr].key) {
 
         // First case: curr is a leaf
-        if (curr->isLeaf()) {
+        if (nodes[curr].isLeaf()) {
             // disconnect the node from its parent:
-            if (parent != nullptr) {
-                if (curr == parent->left) {
-                    parent->left = nullptr;
+            if (parent != NIL) {
+                if (curr == nodes[parent].left) {
+                    nodes[parent].left = NIL;
                 }
                 else {
-                    parent->right = nullptr;
+                    nodes[parent].right = NIL;
                 }
             }
             else {
                 // curr is the root and has no sons
-                root = nullptr;
+                root = NIL;
             }
-            delete curr;
+            nodes.release(curr);
             return;
         }
 
         // Second case: curr has one son
-        else if (curr->left == nullptr || curr->right == nullptr) {
+        else if (nodes[curr].left == NIL || nodes[curr].right == NIL) {
+            NodeIndex son = (nodes[curr].left != NIL) ? nodes[curr].left : nodes[curr].right;
             // Update the "extra" in curr's son
-            if (curr->left) {
-                curr->left->extra += curr->extra;
-                curr->left->updateMaxRank();
-            }
-            else {
-                curr->right->extra += curr->extra;
-                curr->right->updateMaxRank();
-            }
+            nodes[son].extra += nodes[curr].extra;
+            updateMaxRank(son);
 
             // disconnect the node from its parent:
-            if (parent != nullptr) {
-                if (parent->left->key == curr->key) {
+            if (parent != NIL) {
+                if (nodes[parent].left == curr) {
                     // curr is the left child of its parent
-                    if (curr->left != nullptr) {
-                        parent->left = curr->left;
-                    }
-                    else {
-                        parent->left = curr->right;
-                    }
+                    nodes[parent].left = son;
                 }
                 else {
                     // curr is the right child of its parent
-                    if (curr->left != nullptr) {
-                        parent->right = curr->left;
-                    }
-                    else {
-                        parent->right = curr->right;
-                    }
+                    nodes[parent].right = son;
                 }
             }
             else {
                 // curr is the root and has one son:
-                if (curr->left != nullptr) {
-                    root = curr->left;
-                }
-                else {
-                    root = curr->right;
-                }
+                root = son;
             }
-            delete curr;
+            nodes.release(curr);
             return;
         }
 
         // Third case: curr has two sons
         else {
-            Node* nextNode = curr->nextInSubtree();
+            NodeIndex nextNode = nextInSubtree(curr);
             // Swap the node with the next node in the subtree.
             // Update the extra to be the correct amount of wins for the next node
-            int wins = get_num_wins(nextNode->key);
-            int removed_node_wins = get_num_wins(curr->key);
-            curr->swap(nextNode);
+            int wins = get_num_wins(nodes[nextNode].key);
+            int removed_node_wins = get_num_wins(nodes[curr].key);
+            swap(curr, nextNode);
             int diff = wins - removed_node_wins;
-            curr->extra += diff;
+            nodes[curr].extra += diff;
             // Subtract the diff in "extra" in curr node from the sons
-            if (curr->right) {
-                curr->right->extra -= diff;
-                curr->right->updateMaxRank();
+            NodeIndex right = nodes[curr].right;
+            NodeIndex left = nodes[curr].left;
+            if (right) {
+                nodes[right].extra -= diff;
+                updateMaxRank(right);
             }
-            if (curr->left) {
-                curr->left->extra -= diff;
-                curr->left->updateMaxRank();
+            if (left) {
+                nodes[left].extra -= diff;
+                updateMaxRank(left);
             }
-            curr->updateMaxRank();
-            eraseInner(key, curr->right, curr);
+            updateMaxRank(curr);
+            eraseInner(key, right, curr);
         }
     }
 
     // If the node to remove not yet found, continue searching down the tree:
-    else if (curr->key > key) {
-        eraseInner(key, curr->left, curr);
+    else if (nodes[curr].key > key) {
+        eraseInner(key, nodes[curr].left, curr);
     }
     else {
-        eraseInner(key, curr->right, curr);
+        eraseInner(key, nodes[curr].right, curr);
     }
-    curr->updateHeight();
-    curr->updateSubtreeSize();
-    curr->updateMaxRank();
+    updateHeight(curr);
+    updateSubtreeSize(curr);
+    updateMaxRank(curr);
     reBalanceSubTree(curr, parent);
 }
 
@@ -495,17 +618,17 @@ void RankTree<K,T>::eraseInner(const K &key, RankTree::Node *curr, RankTree::Nod
 /* Complexity: time: O(1), space: O(1)
  */
 template<typename K, typename T>
-void RankTree<K,T>::reBalanceSubTree(RankTree::Node *node, RankTree::Node *parent) {
-    if (node->BalanceFactor() == 2) {
-        if (node->left->BalanceFactor() > -1) {
+void RankTree<K,T>::reBalanceSubTree(NodeIndex node, NodeIndex parent) {
+    if (BalanceFactor(node) == 2) {
+        if (BalanceFactor(nodes[node].left) > -1) {
             leftLeftFix(node, parent);
         }
         else {
             leftRightFix(node, parent);
         }
     }
-    else if (node->BalanceFactor() == -2) {
-        if (node->right->BalanceFactor() < 1) {
+    else if (BalanceFactor(node) == -2) {
+        if (BalanceFactor(nodes[node].right) < 1) {
             rightRightFix(node, parent);
         }
         else {
@@ -515,42 +638,42 @@ void RankTree<K,T>::reBalanceSubTree(RankTree::Node *node, RankTree::Node *paren
 }
 
 
-/* Complexity: time: O(n), space: O(log n)
+/* Complexity: time: O(1), space: O(1)
+ * All the nodes are released together with the pool.
  */
 template<typename K, typename T>
 RankTree<K,T>::~RankTree() {
-    clearTree(root);
-    root = nullptr;
+    clearTree();
 }
 
 
 /* Complexity: time: O(1), space: O(1)
  */
 template<typename K, typename T>
-void RankTree<K,T>::leftLeftFix(RankTree::Node *node, RankTree::Node *parent) {
+void RankTree<K,T>::leftLeftFix(NodeIndex node, NodeIndex parent) {
     rotateRight(node, parent);
 }
 
 /* Complexity: time: O(1), space: O(1)
  */
 template<typename K, typename T>
-void RankTree<K,T>::leftRightFix(RankTree::Node *node, RankTree::Node *parent) {
-    rotateLeft(node->left, node);
+void RankTree<K,T>::leftRightFix(NodeIndex node, NodeIndex parent) {
+    rotateLeft(nodes[node].left, node);
     rotateRight(node, parent);
 }
 
 /* Complexity: time: O(1), space: O(1)
  */
 template<typename K, typename T>
-void RankTree<K,T>::rightRightFix(RankTree::Node *node, RankTree::Node *parent) {
+void RankTree<K,T>::rightRightFix(NodeIndex node, NodeIndex parent) {
     rotateLeft(node, parent);
 }
 
 /* Complexity: time: O(1), space: O(1)
  */
 template<typename K, typename T>
-void RankTree<K,T>::rightLeftFix(RankTree::Node *node, RankTree::Node *parent) {
-    rotateRight(node->right, node);
+void RankTree<K,T>::rightLeftFix(NodeIndex node, NodeIndex parent) {
+    rotateRight(nodes[node].right, node);
     rotateLeft(node, parent);
 }
 
@@ -558,85 +681,85 @@ void RankTree<K,T>::rightLeftFix(RankTree::Node *node, RankTree::Node *parent) {
 /* Complexity: time: O(1), space: O(1)
  */
 template<typename K, typename T>
-void RankTree<K,T>::rotateLeft(RankTree::Node *node, RankTree::Node *parent) {
+void RankTree<K,T>::rotateLeft(NodeIndex node, NodeIndex parent) {
     if (node == root) {
-        root = node->right;
-    }
-    Node* tmpParent = node->right;
-    Node* tmpSon = node->right->left;
-    node->right->left = node;
-    node->right = tmpSon;
-    if (parent != nullptr) {
-        if (parent->key > node->key) {
-            parent->left = tmpParent;
+        root = nodes[node].right;
+    }
+    NodeIndex tmpParent = nodes[node].right;
+    NodeIndex tmpSon = nodes[tmpParent].left;
+    nodes[tmpParent].left = node;
+    nodes[node].right = tmpSon;
+    if (parent != NIL) {
+        if (nodes[parent].left == node) {
+            nodes[parent].left = tmpParent;
         } else {
-            parent->right = tmpParent;
+            nodes[parent].right = tmpParent;
         }
     }
-    node->updateHeight();
-    tmpParent->updateHeight();
+    updateHeight(node);
+    updateHeight(tmpParent);
 
     // Update subtree size:
-    node->updateSubtreeSize();
-    tmpParent->updateSubtreeSize();
+    updateSubtreeSize(node);
+    updateSubtreeSize(tmpParent);
     // Update the "extra":
-    tmpParent->extra += node->extra;
-    node->extra -= tmpParent->extra;
+    nodes[tmpParent].extra += nodes[node].extra;
+    nodes[node].extra -= nodes[tmpParent].extra;
     if (tmpSon) {
-        tmpSon->extra -= node->extra;
-        tmpSon->updateMaxRank();
+        nodes[tmpSon].extra -= nodes[node].extra;
+        updateMaxRank(tmpSon);
     }
     // Update max_rank:
-    node->updateMaxRank();
-    tmpParent->updateMaxRank();
+    updateMaxRank(node);
+    updateMaxRank(tmpParent);
 }
 
 
 /* Complexity: time: O(1), space: O(1)
  */
 template<typename K, typename T>
-void RankTree<K,T>::rotateRight(RankTree::Node *node, RankTree::Node *parent) {
+void RankTree<K,T>::rotateRight(NodeIndex node, NodeIndex parent) {
     if (node == root) {
-        root = node->left;
-    }
-    Node* tmpParent = node->left;
-    Node* tmpSon = node->left->right;
-    node->left->right = node;
-    node->left = tmpSon;
-    if (parent != nullptr) {
-        if (parent->key > node->key) {
-            parent->left = tmpParent;
+        root = nodes[node].left;
+    }
+    NodeIndex tmpParent = nodes[node].left;
+    NodeIndex tmpSon = nodes[tmpParent].right;
+    nodes[tmpParent].right = node;
+    nodes[node].left = tmpSon;
+    if (parent != NIL) {
+        if (nodes[parent].left == node) {
+            nodes[parent].left = tmpParent;
         } else {
-            parent->right = tmpParent;
+            nodes[parent].right = tmpParent;
         }
     }
-    node->updateHeight();
-    tmpParent->updateHeight();
+    updateHeight(node);
+    updateHeight(tmpParent);
 
     // Update subtree size:
-    node->updateSubtreeSize();
-    tmpParent->updateSubtreeSize();
+    updateSubtreeSize(node);
+    updateSubtreeSize(tmpParent);
     // Update the "extra":
-    tmpParent->extra += node->extra;
-    node->extra -= tmpParent->extra;
+    nodes[tmpParent].extra += nodes[node].extra;
+    nodes[node].extra -= nodes[tmpParent].extra;
     if (tmpSon) {
-        tmpSon->extra -= node->extra;
-        tmpSon->updateMaxRank();
+        nodes[tmpSon].extra -= nodes[node].extra;
+        updateMaxRank(tmpSon);
     }
     // Update max_rank:
-    node->updateMaxRank();
-    tmpParent->updateMaxRank();
+    updateMaxRank(node);
+    updateMaxRank(tmpParent);
 }
 
 
 /* Complexity: time: O(log n), space: O(1)
- * Returns pointer to the next node in-order. If the node is last in the tree, returns nullptr.
+ * Returns the index of the next node in-order inside the subtree of "node" (assumes "node" has a right son).
  */
 template<typename K, typename T>
-typename RankTree<K,T>::Node *RankTree<K,T>::Node::nextInSubtree() {
-    Node* curr = this->right;
-    while (curr->left != nullptr) {
-        curr = curr->left;
+NodeIndex RankTree<K,T>::nextInSubtree(NodeIndex node) const {
+    NodeIndex curr = nodes[node].right;
+    while (nodes[curr].left != NIL) {
+        curr = nodes[curr].left;
     }
     return curr;
 }
@@ -646,33 +769,166 @@ typename RankTree<K,T>::Node *RankTree<K,T>::Node::nextInSubtree() {
  */
 template<typename K, typename T>
 T *RankTree<K,T>::find(const K& key) {
-    Node* curr = root;
-    while (curr != nullptr) {
-        if (curr->key == key) {
-            return curr->info;
+    NodeIndex curr = root;
+    while (curr != NIL) {
+        if (nodes[curr].key == key) {
+            return node_infos[curr - 1];
         }
-        else if (curr->key > key) {
-            curr = curr->left;
+        else if (nodes[curr].key > key) {
+            curr = nodes[curr].left;
         }
         else {
-            curr = curr->right;
+            curr = nodes[curr].right;
         }
     }
     return nullptr;
 }
 
 
+/* Complexity: time: O(1), space: O(1)
+ * Removes all the nodes of the tree by releasing its node pool.
+ */
+template<typename K, typename T>
+void RankTree<K,T>::clearTree() {
+    nodes.clear();
+    delete[] node_infos;
+    node_infos = nullptr;
+    infos_capacity = 0;
+    root = NIL;
+    size = 0;
+    version++;
+}
+
+
+/* Complexity: time: O(log n), space: O(1)
+ * Iterators over the keys in increasing order (begin) or decreasing order (rbegin), see TreeIterator.
+ * They are invalidated by any change to the tree.
+ */
+template<typename K, typename T>
+typename RankTree<K, T>::Iterator RankTree<K, T>::begin() const {
+    return Iterator::fromSubtree(nodes, root, false, node_infos);
+}
+
+
+template<typename K, typename T>
+typename RankTree<K, T>::Iterator RankTree<K, T>::rbegin() const {
+    return Iterator::fromSubtree(nodes, root, true, node_infos);
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename K, typename T>
+typename RankTree<K, T>::Iterator RankTree<K, T>::end() const {
+    return Iterator();
+}
+
+
+/* Complexity: time: O(log n), space: O(1)
+ * Starts at the smallest key >= key (beginAt), or at the largest key <= key going down (rbeginAt).
+ */
+template<typename K, typename T>
+typename RankTree<K, T>::Iterator RankTree<K, T>::beginAt(const K& key) const {
+    return Iterator::fromKey(nodes, root, key, false, node_infos);
+}
+
+
+template<typename K, typename T>
+typename RankTree<K, T>::Iterator RankTree<K, T>::rbeginAt(const K& key) const {
+    return Iterator::fromKey(nodes, root, key, true, node_infos);
+}
+
+
+/* Complexity: time: O(log n), space: O(1)
+ * Starts at the key of index idx (1 for the smallest key), going up (beginAtIndex) or down (rbeginAtIndex).
+ */
+template<typename K, typename T>
+typename RankTree<K, T>::Iterator RankTree<K, T>::beginAtIndex(int idx) const {
+    return Iterator::fromRank(nodes, root, idx, false, node_infos);
+}
+
+
+template<typename K, typename T>
+typename RankTree<K, T>::Iterator RankTree<K, T>::rbeginAtIndex(int idx) const {
+    return Iterator::fromRank(nodes, root, idx, true, node_infos);
+}
+
+
+/* Complexity: time: O(n), space: O(n)
+ * Replaces the content of the tree with the sorted keys (with no duplicates) and their infos, all with 0 wins.
+ * The tree is built bottom-up with the middle key of each range as the root, so it is balanced.
+ */
+template<typename K, typename T>
+void RankTree<K, T>::buildFromSortedArray(K*& keys, T**& infos, int array_size) {
+    clearTree();
+    nodes.reserve(static_cast<NodeIndex>(array_size));
+    reserveInfos();
+    root = buildFromSortedArrayHelper(keys, infos, 0, array_size - 1);
+    size = array_size;
+}
+
+
+/* Complexity: time: O(n), space: O(1)
+ * Fills the arrays with the keys in increasing order and the number of wins of each key (the sum of the extra
+ * wins on its path from the root), and returns the number of keys. This is one walk over the tree, instead of a
+ * get_num_wins for every key. The arrays must have room for getSize() items.
+ */
+template<typename K, typename T>
+int RankTree<K, T>::insertKeysAndWinsInorderToArrays(K*& keys, int*& wins) const {
+    // The nodes still to be visited, each with the sum of the extra wins from the root down to it
+    NodeIndex path[64];
+    int path_wins[64];
+    int depth = 0;
+    int count = 0;
+    NodeIndex curr = root;
+    int curr_wins = curr != NIL ? nodes[curr].extra : 0;
+    while (curr != NIL || depth > 0) {
+        while (curr != NIL) {
+            path[depth] = curr;
+            path_wins[depth] = curr_wins;
+            depth++;
+            curr = nodes[curr].left;
+            curr_wins += curr != NIL ? nodes[curr].extra : 0;
+        }
+        depth--;
+        keys[count] = nodes[path[depth]].key;
+        wins[count] = path_wins[depth];
+        count++;
+        curr = nodes[path[depth]].right;
+        curr_wins = path_wins[depth] + (curr != NIL ? nodes[curr].extra : 0);
+    }
+    return count;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * A number that changes whenever the keys, their order or their wins change (and when the tree is swapped with
+ * another), so a copy of the tree's content can tell if it is still up to date.
+ */
+template<typename K, typename T>
+unsigned long long RankTree<K, T>::getVersion() const {
+    return version;
+}
+
+
 /* Complexity: time: O(n), space: O(log n)
  */
 template<typename K, typename T>
-void RankTree<K,T>::clearTree(RankTree::Node* node) {
-    if (node == nullptr) {
-        return;
+NodeIndex RankTree<K, T>::buildFromSortedArrayHelper(K*& keys, T**& infos, int low, int high) {
+    if (low > high) {
+        return NIL;
     }
-    clearTree(node->left);
-    clearTree(node->right);
-    delete node;
-    size -= 1;
+    int mid = low + (high - low) / 2;
+    NodeIndex node = nodes.allocate(Node(keys[mid]));
+    node_infos[node - 1] = infos[mid];
+    NodeIndex left = buildFromSortedArrayHelper(keys, infos, low, mid - 1);
+    NodeIndex right = buildFromSortedArrayHelper(keys, infos, mid + 1, high);
+    nodes[node].left = left;
+    nodes[node].right = right;
+    updateHeight(node);
+    updateSubtreeSize(node);
+    updateMaxRank(node);
+    return node;
 }
 
 
@@ -690,16 +946,16 @@ int RankTree<K, T>::get_index_from_key(const K& key){
 /* Complexity: time: O(log n), space: O(log n)
  */
 template<typename K, typename T>
-int RankTree<K, T>::get_index_from_key_helper(const K& key, Node* node) {
+int RankTree<K, T>::get_index_from_key_helper(const K& key, NodeIndex node) {
     int left_subTree_size = 0;
-    if(node->left){
-        left_subTree_size = node->left->subtree_size;
+    if(nodes[node].left){
+        left_subTree_size = nodes[nodes[node].left].subtree_size;
     }
-    if(node->key > key) {
-        return get_index_from_key_helper(key, node->left);
+    if(nodes[node].key > key) {
+        return get_index_from_key_helper(key, nodes[node].left);
     }
-    else if(node->key < key){
-        return left_subTree_size + 1 + get_index_from_key_helper(key, node->right);
+    else if(nodes[node].key < key){
+        return left_subTree_size + 1 + get_index_from_key_helper(key, nodes[node].right);
     }
     else{ // (key == node->key)
         return left_subTree_size + 1;
@@ -714,23 +970,23 @@ K RankTree<K, T>::get_key_from_index(int idx){
     if(idx <= 0 || idx > size){
         return default_key;
     }
-    Node * node = root;
+    NodeIndex node = root;
     int counter = 0;
     while(counter != idx){
         int left_subTree_size = 0;
-        if(node->left){
-            left_subTree_size = node->left->subtree_size;
+        if(nodes[node].left){
+            left_subTree_size = nodes[nodes[node].left].subtree_size;
         }
         counter += left_subTree_size + 1;
         if(counter > idx) {
             counter -= left_subTree_size + 1;
-            node = node->left;
+            node = nodes[node].left;
         }
         else if(counter < idx){
-            node = node->right;
+            node = nodes[node].right;
         }
         else { // counter == idx
-            return node->key;
+            return nodes[node].key;
         }
     }
     return default_key;
@@ -751,37 +1007,39 @@ void RankTree<K, T>::add_wins(const K& key, int x){
 /* Complexity: time: O(log n), space: O(log n)
  */
 template<typename K, typename T>
-void RankTree<K, T>::add_wins_helper(const K& key, int x, Node* node, bool right_streak){
-    if(node->key == key){
+void RankTree<K, T>::add_wins_helper(const K& key, int x, NodeIndex node, bool right_streak){
+    Node& curr = nodes[node];
+    if(curr.key == key){
         if(!right_streak) {
-            node->extra += x;
+            curr.extra += x;
         }
-        if(node->right){
-            node->right->extra -= x;
-            node->right->updateMaxRank();
+        if(curr.right){
+            nodes[curr.right].extra -= x;
+            updateMaxRank(curr.right);
         }
-        if (node->left) {
-            node->left->updateMaxRank();
+        if (curr.left) {
+            updateMaxRank(curr.left);
         }
-        node->updateMaxRank();
+        updateMaxRank(node);
         return;
     }
-    if(node->key > key) {
+    if(curr.key > key) {
         if(right_streak){
-            node->extra -= x;
+            curr.extra -= x;
         }
-        add_wins_helper(key, x, node->left, false);
+        add_wins_helper(key, x, curr.left, false);
     }
-    if(node->key < key){
+    if(curr.key < key){
         if(!right_streak){
-            node->extra += x;
+            curr.extra += x;
         }
-        add_wins_helper(key, x, node->right, true);
+        add_wins_helper(key, x, curr.right, true);
     }
-    node->updateMaxRank();
+    updateMaxRank(node);
 }
 
 
+
 /* Complexity: time: O(log n), space: O(log n)
  */
 template<typename K, typename T>
@@ -789,6 +1047,7 @@ void RankTree<K, T>::add_wins_in_range(const K &min_key, const K &max_key, int x
     if (min_key > max_key || x == 0) {
         return;
     }
+    version++;
     add_wins(max_key, x);
     K prev = getPrevKey(min_key);
     if (prev != default_key) {
@@ -797,56 +1056,266 @@ void RankTree<K, T>::add_wins_in_range(const K &min_key, const K &max_key, int x
 }
 
 
+/* Complexity: time: O(m log(n/m + 1)) for m keys, space: O(log n)
+ * Adds wins[i] wins to keys[i] (only to that key), for keys sorted in increasing order with no duplicates.
+ * Keys that are not in the tree are skipped. Instead of an add_wins_in_range per key, the keys are split between
+ * the subtrees on a single descent from the root, so every node on the paths to the keys is updated once.
+ */
 template<typename K, typename T>
-void RankTree<K, T>::print_inorder_indexes() {
-    print_inorder_indexes_helper(root);
-    std::cout << std::endl;
+void RankTree<K, T>::add_wins_to_keys(const K* keys, const int* wins, int count) {
+    if (count <= 0) {
+        return;
+    }
+    version++;
+    add_wins_to_keys_helper(keys, wins, 0, count, root);
 }
 
 
+/* Complexity: time: O(m log(n/m + 1)) for the m keys in [low, high), space: O(log n)
+ * The keys in [low, high) are all in the subtree of node. Adding x to the node alone is adding x to its extra
+ * and -x to the extra of its sons, so the wins of its subtrees do not change.
+ */
 template<typename K, typename T>
-void RankTree<K, T>::print_inorder_indexes_helper(Node* node) {
-    if (!node) {
+void RankTree<K, T>::add_wins_to_keys_helper(const K* keys, const int* wins, int low, int high, NodeIndex node) {
+    if (low >= high || node == NIL) {
         return;
     }
-    print_inorder_indexes_helper(node->left);
-    int idx = get_index_from_key(node->key);
-    std::cout << idx << " ";
-    if (node->key != get_key_from_index(idx)) {
-        std::cout << "Problem in node ";
+    const K& node_key = nodes[node].key;
+    // Binary search for the first key that is not smaller than the node's key
+    int split_low = low, split_high = high;
+    while (split_low < split_high) {
+        int mid = split_low + (split_high - split_low) / 2;
+        if (keys[mid] < node_key) {
+            split_low = mid + 1;
+        }
+        else {
+            split_high = mid;
+        }
+    }
+    int split = split_low;
+    bool has_node_key = split < high && keys[split] == node_key;
+    NodeIndex left = nodes[node].left;
+    NodeIndex right = nodes[node].right;
+    if (has_node_key) {
+        nodes[node].extra += wins[split];
+        if (left) {
+            nodes[left].extra -= wins[split];
+        }
+        if (right) {
+            nodes[right].extra -= wins[split];
+        }
+    }
+    add_wins_to_keys_helper(keys, wins, low, split, left);
+    add_wins_to_keys_helper(keys, wins, split + has_node_key, high, right);
+    if (left) {
+        updateMaxRank(left);
     }
-    print_inorder_indexes_helper(node->right);
+    if (right) {
+        updateMaxRank(right);
+    }
+    updateMaxRank(node);
 }
 
+
+/* One end of a range of add_wins_in_ranges: adds "wins" to every key below "key" (and to "key" itself if
+ * inclusive). A range [min, max] of x wins is x below max (inclusive) and -x below min (exclusive).
+ * Bounds are ordered by key, an exclusive bound before an inclusive one on the same key, and then by "order", so
+ * that no two are equal. In this order, the bounds that do not reach a key are a prefix of any sorted array.
+ */
 template<typename K, typename T>
-void RankTree<K, T>::print_inorder() {
-    print_inorder_helper(root);
+class RankTree<K,T>::WinsBound {
+public:
+    K key;
+    bool inclusive;
+    int order;
+    int wins;
+    WinsBound() : key(), inclusive(false), order(0), wins(0) {};
+    WinsBound(const K& key, bool inclusive, int order, int wins) : key(key), inclusive(inclusive), order(order),
+                                                                  wins(wins) {};
+    bool reaches(const K& other) const {
+        return other < key || (inclusive && other == key);
+    }
+    bool operator<(const WinsBound& other) const {
+        if (key != other.key) {
+            return key < other.key;
+        }
+        if (inclusive != other.inclusive) {
+            return !inclusive;
+        }
+        return order < other.order;
+    }
+};
+
+
+/* Complexity: time: O(m log m + m log(n/m + 1)) for m updates, space: O(m + log n)
+ * Applies all the updates, as if add_wins_in_range was called for each of them, except that the updates do not
+ * need their min_key and max_key to be in the tree: the wins go to the keys of the tree inside the range.
+ * The ends of all the ranges are sorted, and then split between the subtrees on a single descent from the root,
+ * so every node on the paths to the ends is updated once instead of twice per update.
+ * Throws std::bad_alloc (with the tree unchanged) if the memory can not be allocated.
+ */
+template<typename K, typename T>
+void RankTree<K, T>::add_wins_in_ranges(const RangeWins* updates, int count) {
+    int num_bounds = 0;
+    WinsBound* bounds = new WinsBound[2 * count];
+    int* suffix_wins;
+    try {
+        suffix_wins = new int[2 * count + 1];
+    }
+    catch (const std::bad_alloc&) {
+        delete[] bounds;
+        throw;
+    }
+    for (int i=0; i<count; i++) {
+        if (updates[i].min_key > updates[i].max_key || updates[i].wins == 0) {
+            continue;
+        }
+        bounds[num_bounds] = WinsBound(updates[i].max_key, true, num_bounds, updates[i].wins);
+        bounds[num_bounds + 1] = WinsBound(updates[i].min_key, false, num_bounds + 1, -updates[i].wins);
+        num_bounds += 2;
+    }
+    try {
+        sortKeys(bounds, num_bounds);
+    }
+    catch (const std::bad_alloc&) {
+        delete[] bounds;
+        delete[] suffix_wins;
+        throw;
+    }
+    // suffix_wins[i] is the sum of the wins of bounds i and up, so any range of bounds is summed in O(1)
+    suffix_wins[num_bounds] = 0;
+    for (int i=num_bounds-1; i>=0; i--) {
+        suffix_wins[i] = suffix_wins[i + 1] + bounds[i].wins;
+    }
+    if (num_bounds > 0) {
+        version++;
+        add_wins_in_ranges_helper(bounds, suffix_wins, 0, num_bounds, root);
+    }
+    delete[] bounds;
+    delete[] suffix_wins;
 }
 
+
+/* Complexity: time: O(m log(n/m + 1)) for the m bounds in [low, high), space: O(log n)
+ * Applies the bounds in [low, high) to the subtree of node (the other bounds were applied above it).
+ * The bounds that reach the node's key give their wins to the node, and so to the whole subtree. Above the node's
+ * key they only reach part of the right subtree, so the right son gets them back (-wins) and they go on to it.
+ * The bounds that do not reach the node's key only reach keys in the left subtree, and go on to it.
+ */
 template<typename K, typename T>
-void RankTree<K, T>::print_inorder_helper(Node* node) {
-    if (!node) {
+void RankTree<K, T>::add_wins_in_ranges_helper(const WinsBound* bounds, const int* suffix_wins, int low, int high,
+                                               NodeIndex node) {
+    if (low >= high || node == NIL) {
         return;
     }
-    print_inorder_helper(node->left);
-    std::cout << "strength: " << node->key.first << " team_id:  " << node->key.second << std::endl;
-    print_inorder_helper(node->right);
+    const K& node_key = nodes[node].key;
+    // Binary search for the first bound that reaches the node's key
+    int split_low = low, split_high = high;
+    while (split_low < split_high) {
+        int mid = split_low + (split_high - split_low) / 2;
+        if (bounds[mid].reaches(node_key)) {
+            split_high = mid;
+        }
+        else {
+            split_low = mid + 1;
+        }
+    }
+    int split = split_low;
+    int reaching_wins = suffix_wins[split] - suffix_wins[high];
+    NodeIndex left = nodes[node].left;
+    NodeIndex right = nodes[node].right;
+    if (reaching_wins != 0) {
+        nodes[node].extra += reaching_wins;
+        if (right) {
+            nodes[right].extra -= reaching_wins;
+        }
+    }
+    add_wins_in_ranges_helper(bounds, suffix_wins, low, split, left);
+    add_wins_in_ranges_helper(bounds, suffix_wins, split, high, right);
+    if (left) {
+        updateMaxRank(left);
+    }
+    if (right) {
+        updateMaxRank(right);
+    }
+    updateMaxRank(node);
 }
 
+
+/* Complexity: time: O(1), space: O(1)
+ */
 template<typename K, typename T>
-void RankTree<K, T>::print_inorder_wins() {
-    print_inorder_wins_helper(root);
+void RankTree<K, T>::swapTrees(RankTree<K, T> &tree2) noexcept {
+    nodes.swap(tree2.nodes);
+
+    T** temp_infos = node_infos;
+    node_infos = tree2.node_infos;
+    tree2.node_infos = temp_infos;
+
+    NodeIndex temp_capacity = infos_capacity;
+    infos_capacity = tree2.infos_capacity;
+    tree2.infos_capacity = temp_capacity;
+
+    NodeIndex tempRoot = this->root;
+    this->root = tree2.root;
+    tree2.root = tempRoot;
+
+    int tempSize = this->size;
+    this->size = tree2.size;
+    tree2.size = tempSize;
+
+    // Both trees now hold different nodes, so both get a version neither of them had before
+    unsigned long long new_version = (version > tree2.version ? version : tree2.version) + 1;
+    version = new_version;
+    tree2.version = new_version;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Takes the nodes of "other", leaving it empty.
+ */
+template<typename K, typename T>
+RankTree<K, T>::RankTree(RankTree<K, T>&& other) noexcept : node_infos(nullptr), infos_capacity(0), root(NIL),
+                                                               size(0), default_key(K()), version(0) {
+    swapTrees(other);
 }
 
+
+/* Complexity: time: O(1), space: O(1)
+ * Takes the nodes of "other". The previous nodes are released together with "other".
+ */
 template<typename K, typename T>
-void RankTree<K, T>::print_inorder_wins_helper(Node* node) {
-    if (!node) {
-        return;
+RankTree<K, T>& RankTree<K, T>::operator=(RankTree<K, T>&& other) noexcept {
+    swapTrees(other);
+    return *this;
+}
+
+
+template<typename K, typename T>
+void RankTree<K, T>::print_inorder_indexes() {
+    for (Iterator it = begin(); !it.isEnd(); ++it) {
+        int idx = get_index_from_key(it.key());
+        std::cout << idx << " ";
+        if (it.key() != get_key_from_index(idx)) {
+            std::cout << "Problem in node ";
+        }
+    }
+    std::cout << std::endl;
+}
+
+template<typename K, typename T>
+void RankTree<K, T>::print_inorder() {
+    for (Iterator it = begin(); !it.isEnd(); ++it) {
+        std::cout << "strength: " << it.key().first << " team_id:  " << it.key().second << std::endl;
+    }
+}
+
+template<typename K, typename T>
+void RankTree<K, T>::print_inorder_wins() {
+    for (Iterator it = begin(); !it.isEnd(); ++it) {
+        std::cout << "strength: " << it.key().first << " team_id: " << it.key().second
+            << " wins: " << get_num_wins(it.key()) << std::endl;
     }
-    print_inorder_wins_helper(node->left);
-    std::cout << "strength: " << node->key.first << " team_id: " << node->key.second
-        << " wins: " << get_num_wins(node->key) << std::endl;
-    print_inorder_wins_helper(node->right);
 }
 
 
@@ -0,0 +1,63 @@
+#ifndef DS_WET2_SIMDMATCH_H
+#define DS_WET2_SIMDMATCH_H
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define SIMD_MATCH_AVX2 1
+#endif
+
+
+/* Complexity: time: O(count), space: O(1)
+ * Decides "count" matches: the winner of match i is the team with the higher strength, or on equal strengths the
+ * team with the lower id. winners[i] is set to ids1[i] or ids2[i].
+ */
+inline void pickWinnersScalar(const int* strengths1, const int* strengths2, const int* ids1, const int* ids2,
+                              int count, int* winners) {
+    for (int i=0; i<count; i++) {
+        bool first_wins = (strengths1[i] > strengths2[i]) | ((strengths1[i] == strengths2[i]) & (ids1[i] < ids2[i]));
+        winners[i] = first_wins ? ids1[i] : ids2[i];
+    }
+}
+
+
+#ifdef SIMD_MATCH_AVX2
+
+/* Complexity: time: O(count), space: O(1)
+ * The AVX2 version of pickWinnersScalar: decides 8 matches per step, the last matches are decided by scalar code.
+ */
+__attribute__((target("avx2")))
+inline void pickWinnersAVX2(const int* strengths1, const int* strengths2, const int* ids1, const int* ids2,
+                            int count, int* winners) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i s1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(strengths1 + i));
+        __m256i s2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(strengths2 + i));
+        __m256i id1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ids1 + i));
+        __m256i id2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ids2 + i));
+        __m256i tie_break = _mm256_and_si256(_mm256_cmpeq_epi32(s1, s2), _mm256_cmpgt_epi32(id2, id1));
+        __m256i first_wins = _mm256_or_si256(_mm256_cmpgt_epi32(s1, s2), tie_break);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(winners + i), _mm256_blendv_epi8(id2, id1, first_wins));
+    }
+    pickWinnersScalar(strengths1 + i, strengths2 + i, ids1 + i, ids2 + i, count - i, winners + i);
+}
+
+#endif // SIMD_MATCH_AVX2
+
+
+/* Complexity: time: O(count), space: O(1)
+ * pickWinnersScalar, using the AVX2 kernel when the CPU supports it (checked once at runtime).
+ */
+inline void pickWinners(const int* strengths1, const int* strengths2, const int* ids1, const int* ids2, int count,
+                        int* winners) {
+#ifdef SIMD_MATCH_AVX2
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    if (has_avx2) {
+        pickWinnersAVX2(strengths1, strengths2, ids1, ids2, count, winners);
+        return;
+    }
+#endif
+    pickWinnersScalar(strengths1, strengths2, ids1, ids2, count, winners);
+}
+
+
+#endif //DS_WET2_SIMDMATCH_H
@@ -0,0 +1,151 @@
+#ifndef DS_WET2_SIMDMERGE_H
+#define DS_WET2_SIMDMERGE_H
+
+#include "Pair.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define SIMD_MERGE_AVX2 1
+#endif
+
+
+/* Complexity: time: O(size_a+size_b), space: O(1)
+ * Merges two sorted arrays that have no common keys.
+ * Returns the size of the merged array.
+ */
+template<typename K>
+int mergeDistinctKeys(K*& mergedArray, K*& array_a, int size_a, K*& array_b, int size_b) {
+    int ia = 0, ib = 0, i = 0;
+    while ( (ia < size_a) & (ib < size_b)) {
+        bool take_b = array_b[ib] < array_a[ia];
+        mergedArray[i] = take_b ? array_b[ib] : array_a[ia];
+        ib += take_b;
+        ia += !take_b;
+        i++;
+    }
+    for (; ia < size_a; ia++, i++) {
+        mergedArray[i] = array_a[ia];
+    }
+    for (; ib < size_b; ib++, i++) {
+        mergedArray[i] = array_b[ib];
+    }
+    return i;
+}
+
+
+#ifdef SIMD_MERGE_AVX2
+
+/* In the AVX2 kernel every Pair is held in a 64-bit lane as (first << 32) | (second ^ 0x7FFFFFFF):
+ * a signed 64-bit compare of two lanes then gives the Pair order (first ascending, second descending).
+ * A Pair in memory is (first, second) as two 32-bit words, so the conversion is a xor and a swap of the words.
+ */
+__attribute__((target("avx2")))
+inline __m256i pairsToLanes(const Pair* pairs) {
+    const __m256i flip = _mm256_set1_epi64x(0x7FFFFFFFLL << 32);
+    __m256i raw = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pairs));
+    return _mm256_shuffle_epi32(_mm256_xor_si256(raw, flip), 0xB1);
+}
+
+__attribute__((target("avx2")))
+inline void lanesToPairs(Pair* pairs, __m256i lanes) {
+    const __m256i flip = _mm256_set1_epi64x(0x7FFFFFFFLL << 32);
+    __m256i raw = _mm256_xor_si256(_mm256_shuffle_epi32(lanes, 0xB1), flip);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(pairs), raw);
+}
+
+/* Bitonic merge network: given two sorted vectors of 4 keys, leaves the 4 smallest keys sorted in "low" and
+ * the 4 largest keys sorted in "high".
+ */
+__attribute__((target("avx2")))
+inline void bitonicMerge4x4(__m256i& low, __m256i& high) {
+    __m256i reversed = _mm256_permute4x64_epi64(high, 0x1B);
+    __m256i greater = _mm256_cmpgt_epi64(low, reversed);
+    __m256i mins = _mm256_blendv_epi8(low, reversed, greater);
+    __m256i maxs = _mm256_blendv_epi8(reversed, low, greater);
+    __m256i* halves[2] = {&mins, &maxs};
+    for (int h = 0; h < 2; h++) {
+        __m256i v = *halves[h];
+        // Compare lanes (0,2) and (1,3):
+        __m256i other = _mm256_permute4x64_epi64(v, 0x4E);
+        greater = _mm256_cmpgt_epi64(v, other);
+        v = _mm256_blend_epi32(_mm256_blendv_epi8(v, other, greater), _mm256_blendv_epi8(other, v, greater), 0xF0);
+        // Compare lanes (0,1) and (2,3):
+        other = _mm256_permute4x64_epi64(v, 0xB1);
+        greater = _mm256_cmpgt_epi64(v, other);
+        v = _mm256_blend_epi32(_mm256_blendv_epi8(v, other, greater), _mm256_blendv_epi8(other, v, greater), 0xCC);
+        *halves[h] = v;
+    }
+    low = mins;
+    high = maxs;
+}
+
+/* Complexity: time: O(size_a+size_b), space: O(1)
+ * The AVX2 version of mergeDistinctKeys for Pair keys: merges 4 keys per step with bitonicMerge4x4, always loading
+ * the next 4 keys from the array whose next key is smaller. The last keys are merged by scalar code.
+ */
+__attribute__((target("avx2")))
+inline int mergeDistinctPairsAVX2(Pair* merged, const Pair* array_a, int size_a, const Pair* array_b, int size_b) {
+    int ia = 0, ib = 0, i = 0;
+    if (size_a >= 4 && size_b >= 4) {
+        __m256i low = pairsToLanes(array_a);
+        __m256i high = pairsToLanes(array_b);
+        ia = 4;
+        ib = 4;
+        while (true) {
+            bitonicMerge4x4(low, high);
+            lanesToPairs(merged + i, low);
+            i += 4;
+            if (ia + 4 <= size_a && (ib >= size_b || array_a[ia] < array_b[ib])) {
+                low = pairsToLanes(array_a + ia);
+                ia += 4;
+            }
+            else if (ib + 4 <= size_b && (ia >= size_a || array_b[ib] < array_a[ia])) {
+                low = pairsToLanes(array_b + ib);
+                ib += 4;
+            }
+            else {
+                break;
+            }
+        }
+        // Merge the 4 keys left in "high" with the rest of both arrays:
+        Pair rest[4];
+        lanesToPairs(rest, high);
+        int ir = 0;
+        while (ir < 4) {
+            bool take_rest = (ia >= size_a || rest[ir] < array_a[ia]) && (ib >= size_b || rest[ir] < array_b[ib]);
+            if (take_rest) {
+                merged[i++] = rest[ir++];
+            }
+            else if (ib >= size_b || (ia < size_a && array_a[ia] < array_b[ib])) {
+                merged[i++] = array_a[ia++];
+            }
+            else {
+                merged[i++] = array_b[ib++];
+            }
+        }
+    }
+    Pair* out = merged + i;
+    Pair* rest_a = const_cast<Pair*>(array_a) + ia;
+    Pair* rest_b = const_cast<Pair*>(array_b) + ib;
+    return i + mergeDistinctKeys(out, rest_a, size_a - ia, rest_b, size_b - ib);
+}
+
+#endif // SIMD_MERGE_AVX2
+
+
+/* Complexity: time: O(size_a+size_b), space: O(1)
+ * mergeDistinctKeys for Pair keys: uses the AVX2 kernel when the CPU supports it (checked once at runtime),
+ * and the scalar merge otherwise.
+ */
+inline int mergeDistinctKeys(Pair*& mergedArray, Pair*& array_a, int size_a, Pair*& array_b, int size_b) {
+#ifdef SIMD_MERGE_AVX2
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    if (has_avx2) {
+        return mergeDistinctPairsAVX2(mergedArray, array_a, size_a, array_b, size_b);
+    }
+#endif
+    return mergeDistinctKeys<Pair>(mergedArray, array_a, size_a, array_b, size_b);
+}
+
+
+#endif //DS_WET2_SIMDMERGE_H
@@ -1,56 +1,100 @@
 #ifndef DS_WET2_STACK_H
 #define DS_WET2_STACK_H
 
-#include "Pair.h"
-
-class Node {
-public:
-    Pair data;
-    Node * next;
-
-    explicit Node(const Pair& data) : data(data), next(nullptr) {}
-};
+#include <new>
+#include "BlockArena.h"
 
+/* A stack stored in a growable array, so push and pop do not allocate a node per element.
+ * The array comes from the heap, or from a BlockArena if the stack is given one.
+ */
+template<typename T>
 class Stack {
 private:
-    Node* top;
+    T* data;
+    int capacity;
     int size;
+    BlockArena* arena;
+    static const int INIT_CAPACITY = 4;
+
+    void resize(int new_capacity);
+    T* allocateData(int new_capacity) const;
+    void freeData(T* old_data, int old_capacity) const;
 
 public:
     /* Complexity: time: O(1), space: O(1)*/
-    Stack() : top(nullptr), size(0) {}
+    explicit Stack(BlockArena* arena = nullptr) : data(nullptr), capacity(0), size(0), arena(arena) {}
 
-    /* Complexity: time: O(n), space: O(1)*/
+    /* Complexity: time: O(1), space: O(1)*/
     ~Stack() {
-        while (!isEmpty()) {
-            pop();
-        }
+        freeData(data, capacity);
+    }
+
+    Stack(const Stack& other) = delete;
+    Stack& operator=(const Stack& other) = delete;
+
+    /* Complexity: time: O(1), space: O(1)*/
+    Stack(Stack&& other) noexcept : Stack() {
+        swap(other);
     }
 
     /* Complexity: time: O(1), space: O(1)*/
-    void push(const Pair& data) {
-        Node* newNode = new Node(data);
-        newNode->next = top;
-        top = newNode;
-        size++;
+    Stack& operator=(Stack&& other) noexcept {
+        swap(other);
+        return *this;
     }
 
     /* Complexity: time: O(1), space: O(1)*/
-    Pair pop() {
+    void swap(Stack& other) noexcept {
+        T* temp_data = data;
+        data = other.data;
+        other.data = temp_data;
+
+        int temp = capacity;
+        capacity = other.capacity;
+        other.capacity = temp;
+
+        temp = size;
+        size = other.size;
+        other.size = temp;
+
+        BlockArena* temp_arena = arena;
+        arena = other.arena;
+        other.arena = temp_arena;
+    }
+
+    /* Complexity: time: O(n), space: O(wanted_capacity)
+     * Makes room for at least "wanted_capacity" elements, so the next pushes will not resize the stack.*/
+    void reserve(int wanted_capacity) {
+        if (wanted_capacity > capacity) {
+            resize(wanted_capacity);
+        }
+    }
+
+    /* Complexity: time: O(1) amortized, space: O(1) amortized*/
+    void push(const T& element) {
+        if (size == capacity) {
+            resize((capacity == 0) ? INIT_CAPACITY : capacity * 2);
+        }
+        data[size] = element;
+        size++;
+    }
+
+    /* Complexity: time: O(1) amortized, space: O(1)*/
+    T pop() {
         if (!isEmpty()) {
-            Pair topData = top->data;
-            Node* temp = top;
-            top = top->next;
-            delete temp;
             size--;
+            T topData = data[size];
+            if (capacity > INIT_CAPACITY && size <= capacity / 4) {
+                resize(capacity / 2);
+            }
             return topData;
         }
-        return Pair();
+        return T();
     }
 
     /* Complexity: time: O(1), space: O(1)*/
     bool isEmpty() const {
-        return top == nullptr;
+        return size == 0;
     }
 
     /* Complexity: time: O(1), space: O(1)*/
@@ -59,4 +103,46 @@ public:
     }
 };
 
+/* Complexity: time: O(n), space: O(n)
+ * Moves the elements to a new array of the given capacity.
+ */
+template<typename T>
+void Stack<T>::resize(int new_capacity) {
+    T* new_data = allocateData(new_capacity);
+    for (int i = 0; i < size; i++) {
+        new_data[i] = data[i];
+    }
+    freeData(data, capacity);
+    data = new_data;
+    capacity = new_capacity;
+}
+
+/* Complexity: time: O(n), space: O(n)
+ */
+template<typename T>
+T* Stack<T>::allocateData(int new_capacity) const {
+    if (!arena) {
+        return new T[new_capacity];
+    }
+    T* new_data = static_cast<T*>(arena->allocate(sizeof(T) * size_t(new_capacity)));
+    for (int i = 0; i < new_capacity; i++) {
+        new (new_data + i) T();
+    }
+    return new_data;
+}
+
+/* Complexity: time: O(n), space: O(1)
+ */
+template<typename T>
+void Stack<T>::freeData(T* old_data, int old_capacity) const {
+    if (!arena) {
+        delete[] old_data;
+        return;
+    }
+    for (int i = 0; i < old_capacity; i++) {
+        old_data[i].~T();
+    }
+    arena->deallocate(old_data, sizeof(T) * size_t(old_capacity));
+}
+
 #endif //DS_WET2_STACK_H
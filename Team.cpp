@@ -1,8 +1,74 @@
 #include "Team.h"
+#include <thread>
+
+/* Complexity: time: O(1), space: O(1)
+ * Takes the players of "other", leaving it empty.
+ */
+Team::Team(Team&& other) noexcept : Team(other.team_id) {
+    previous_wins = other.previous_wins;
+    pending_wins = other.pending_wins;
+    swap_players(other);
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Swaps the contents of the teams. The previous players are released together with "other".
+ */
+Team& Team::operator=(Team&& other) noexcept {
+    int temp = team_id;
+    team_id = other.team_id;
+    other.team_id = temp;
+
+    temp = previous_wins;
+    previous_wins = other.previous_wins;
+    other.previous_wins = temp;
+
+    temp = pending_wins;
+    pending_wins = other.pending_wins;
+    other.pending_wins = temp;
+
+    swap_players(other);
+    return *this;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Swaps the players of the teams (without changing the team ids and wins).
+ */
+void Team::swap_players(Team& other) noexcept {
+    bool temp_inline = is_inline;
+    is_inline = other.is_inline;
+    other.is_inline = temp_inline;
+
+    int temp_size = inline_size;
+    inline_size = other.inline_size;
+    other.inline_size = temp_size;
+
+    for (int i=0; i<INLINE_CAPACITY; i++) {
+        Player temp_player = inline_sorted[i];
+        inline_sorted[i] = other.inline_sorted[i];
+        other.inline_sorted[i] = temp_player;
+
+        temp_player = inline_order[i];
+        inline_order[i] = other.inline_order[i];
+        other.inline_order[i] = temp_player;
+    }
+
+    players_stack.swap(other.players_stack);
+    players_tree.swapSets(other.players_tree);
+
+    Player temp_median = median_player;
+    median_player = other.median_player;
+    other.median_player = temp_median;
+}
+
 
 /* Complexity: time: O(1), space: O(1)
  */
 int Team::getSize() const {
+    if (is_inline) {
+        return inline_size;
+    }
     return players_tree.getSize();
 }
 
@@ -16,16 +82,72 @@ int Team::get_strength() const {
     return median_player.first * this->getSize();
 }
 
-/* Complexity: time: O(log k), space: O(log k)
+/* Complexity: time: O(log k) amortized, space: O(log k)
+ * Small teams are updated inline without allocating: O(INLINE_CAPACITY) worst case.
  */
 void Team::add_player(int strength) {
     int player_id = this->getSize() + 1;
     Player player = Player(strength, player_id);
-    players_stack.push(player);
-    players_tree.insert(player, nullptr);
+    if (is_inline && inline_size == INLINE_CAPACITY) {
+        promote_to_tree();
+    }
+    if (is_inline) {
+        // Insertion-sort the new player into the sorted array:
+        int i = inline_size;
+        while (i > 0 && inline_sorted[i-1] > player) {
+            inline_sorted[i] = inline_sorted[i-1];
+            i--;
+        }
+        inline_sorted[i] = player;
+        inline_order[inline_size] = player;
+        inline_size++;
+        median_player = inline_sorted[inline_size / 2];
+        return;
+    }
+    players_stack.push(PlayerRecord(player, median_player));
+    players_tree.insert(player);
     update_median_in_insert(player);
 }
 
+/* Complexity: time: O(k + m log m), space: O(k + m)
+ * Adds m players, in the order of the array (the first one gets the lowest new id).
+ * A small batch is added player by player, which costs O(m log k) instead.
+ */
+void Team::add_players(const int* strengths, int count) {
+    int size1 = this->getSize();
+    if ((is_inline && size1 + count <= INLINE_CAPACITY) || (!is_inline && count * log2(size1) < size1)) {
+        for (int i=0; i<count; i++) {
+            add_player(strengths[i]);
+        }
+        return;
+    }
+
+    if (is_inline) {
+        promote_to_tree();
+    }
+    // Reserve the undo log first, so that once the players are in the tree their records can not fail to be pushed:
+    players_stack.reserve(size1 + count);
+    Player* batch = new Player[count];
+    for (int i=0; i<count; i++) {
+        batch[i] = Player(strengths[i], size1 + i + 1);
+    }
+    int actual_size;
+    try {
+        sortKeys(batch, count);
+        actual_size = players_tree.mergeSortedArray(batch, count);
+    }
+    catch (...) {
+        delete[] batch;
+        throw;
+    }
+    delete[] batch;
+    for (int i=0; i<count; i++) {
+        players_stack.push(PlayerRecord(Player(strengths[i], size1 + i + 1), Player()));
+    }
+    this->median_player = players_tree.select(actual_size / 2 + 1, Player());
+}
+
+
 /* Complexity: time: O(log k), space: O(1)
  */
 void Team::update_median_in_insert(Player new_player) {
@@ -55,71 +177,190 @@ void Team::update_median_in_erase(Player removed_player) {
 }
 
 
-/* Complexity: time: O(log k), space: O(log k)
+/* Complexity: time: O(log k) amortized, space: O(log k)
  */
 void Team::remove_newest_player() {
     if (this->getSize() == 0) {
         return;
     }
-    Player removed_player = players_stack.pop();
-    players_tree.erase(removed_player);
-    update_median_in_erase(removed_player);
+    if (is_inline) {
+        inline_size--;
+        Player removed_player = inline_order[inline_size];
+        // Remove the player from the sorted array:
+        int i = 0;
+        while (inline_sorted[i] != removed_player) {
+            i++;
+        }
+        for (; i < inline_size; i++) {
+            inline_sorted[i] = inline_sorted[i+1];
+        }
+        median_player = (inline_size > 0) ? inline_sorted[inline_size / 2] : Player();
+        return;
+    }
+    // Roll back the newest add_player: restore the median it saved if it is known
+    PlayerRecord record = players_stack.pop();
+    players_tree.erase(record.player);
+    if (record.previous_median != Player()) {
+        median_player = record.previous_median;
+    }
+    else {
+        update_median_in_erase(record.player);
+    }
+    if (this->getSize() <= DEMOTE_SIZE) {
+        demote_to_inline();
+    }
 }
 
 
-/* Complexity: time: O(k1 + k2), space: O(k1 + k2)
+/* Complexity: time: O(k), space: O(k)
+ * Moves the players from the inline arrays to the players stack and tree.
  */
-void Team::unite_teams(Team &team2) {
-    if (team2.getSize() == 0) {
-        return;
+void Team::promote_to_tree() {
+    Player* sorted = inline_sorted;
+    players_tree.buildFromSortedArray(sorted, inline_size);
+    for (int i=0; i<inline_size; i++) {
+        players_stack.push(PlayerRecord(inline_order[i], Player()));
     }
+    inline_size = 0;
+    is_inline = false;
+}
 
-    // Move all players from team2 to this team's stack (with new ids)
-    Stack tmp_stack;
-    while (!team2.players_stack.isEmpty()) {
-        Player player = team2.players_stack.pop();
-        player.second += this->getSize(); // increase the player ids in team2 by the current team's size
-        tmp_stack.push(player);
+
+/* Complexity: time: O(k), space: O(log k)
+ * Moves the players from the players stack and tree back to the inline arrays (assumes k <= INLINE_CAPACITY).
+ */
+void Team::demote_to_inline() {
+    int size = players_tree.getSize();
+    Player* sorted = inline_sorted;
+    players_tree.insertKeysInorderToArray(sorted);
+    for (int i=size-1; i>=0; i--) {
+        inline_order[i] = players_stack.pop().player;
     }
-    while (!tmp_stack.isEmpty()) {
-        players_stack.push(tmp_stack.pop());
+    players_tree.clearSet();
+    inline_size = size;
+    is_inline = true;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Removes the newest player from the insertion order only (the sorted players are not updated).
+ */
+Player Team::pop_newest_player() {
+    if (is_inline) {
+        inline_size--;
+        return inline_order[inline_size];
     }
+    return players_stack.pop().player;
+}
 
-    if (this->getSize() == 0) {
-        this->players_tree = team2.players_tree;
-        this->median_player = team2.median_player;
-        team2.players_tree = AVLTree<Player, std::nullptr_t>();
-        team2.median_player = Player();
+
+/* Complexity: time: O(k), space: O(k)
+ * Rebuilds the players tree into a new node pool of exactly its size (from the same arena), with the nodes in
+ * sorted order. If the allocation fails, the team is left as it was.
+ */
+void Team::compact() {
+    if (is_inline) {
         return;
     }
+    int size = players_tree.getSize();
+    Player* sorted = new Player[size];
+    try {
+        players_tree.insertKeysInorderToArray(sorted);
+        // buildFromSortedArray allocates the new pool before it releases the old one:
+        players_tree.buildFromSortedArray(sorted, size);
+    }
+    catch (const std::bad_alloc&) {
+        delete[] sorted;
+        throw;
+    }
+    delete[] sorted;
+}
+
+
+/* Complexity: time: O(k), space: O(log k)
+ * Fills the array with the players of the team sorted by key, and returns the amount of players.
+ */
+int Team::insertPlayersInorderToArray(Player*& array, int num_threads) const {
+    if (is_inline) {
+        for (int i=0; i<inline_size; i++) {
+            array[i] = inline_sorted[i];
+        }
+        return inline_size;
+    }
+    return players_tree.insertKeysInorderToArray(array, num_threads);
+}
+
 
-    // Unite the players trees:
-    // Create an array from each tree:
+/* Complexity: time: O(k1 + k2), space: O(k1 + k2)
+ */
+void Team::unite_teams(Team &team2) {
+    if (team2.getSize() == 0) {
+        return;
+    }
     int size1 = this->getSize();
     int size2 = team2.getSize();
-    Player* array1 = new Player[size1];
+
+    if (size1 == 0) {
+        // This team is empty: take team2's players as they are (their ids do not change)
+        swap_players(team2);
+        return;
+    }
+
+    int num_threads = 1;
+    if (size1 + size2 >= PARALLEL_UNITE_SIZE) {
+        num_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    // Create a sorted array from team2's players (with new ids):
     Player* array2 = new Player[size2];
-    players_tree.insertKeysInorderToArray(array1);
-    team2.players_tree.insertKeysInorderToArray(array2);
+    team2.insertPlayersInorderToArray(array2, num_threads);
     for (int i=0; i<size2; i++) {
         array2[i].second += size1; // increase the player ids in team2 by the current team's size
     }
-    // Merge the arrays into sorted array:
-    Player* merged_array = new Player[size1+size2];
-    int actual_size = mergeSortedKeys(merged_array, array1, size1, array2, size2);
-    // Fill a new tree from the merged array:
-    AVLTree<Player, std::nullptr_t> new_tree;
-    new_tree.nearlyCompleteTree(actual_size, Player());
-    new_tree.insertKeysInorderToTree(merged_array);
-    this->players_tree.swapTrees(new_tree);
 
-    // Update the median: Find the new median in the merged array according to the size
-    this->median_player = merged_array[actual_size / 2];
+    // Take team2's players by insertion order (oldest first, with new ids), leaving team2 empty:
+    Player* order2 = new Player[size2];
+    for (int i=size2-1; i>=0; i--) {
+        order2[i] = team2.pop_newest_player();
+        order2[i].second += size1;
+    }
+    team2.players_tree.clearSet();
+    team2.is_inline = true;
+    team2.inline_size = 0;
+    team2.median_player = Player();
+
+    if (is_inline && size1 + size2 <= INLINE_CAPACITY) {
+        // The united team is still small: merge into the inline arrays
+        Player merged[INLINE_CAPACITY];
+        Player* merged_array = merged;
+        Player* array1 = inline_sorted;
+        int actual_size = mergeDistinctKeys(merged_array, array1, size1, array2, size2);
+        for (int i=0; i<actual_size; i++) {
+            inline_sorted[i] = merged[i];
+        }
+        for (int i=0; i<size2; i++) {
+            inline_order[size1 + i] = order2[i];
+        }
+        inline_size = actual_size;
+        median_player = inline_sorted[actual_size / 2];
+    }
+    else {
+        if (is_inline) {
+            promote_to_tree();
+        }
+        for (int i=0; i<size2; i++) {
+            players_stack.push(PlayerRecord(order2[i], Player()));
+        }
+        // Merge the array into this team's tree:
+        int actual_size = players_tree.mergeSortedArray(array2, size2, num_threads);
+
+        // Update the median: Find the new median in the merged tree according to the size
+        this->median_player = players_tree.select(actual_size / 2 + 1, Player());
+    }
 
     // de-allocate temp arrays
-    delete[] array1;
     delete[] array2;
-    delete[] merged_array;
+    delete[] order2;
 }
 
 
@@ -147,6 +388,18 @@ void Team::set_previous_wins(int wins) {
     previous_wins = wins;
 }
 
+/* Complexity: time: O(1), space: O(1)
+ */
+int Team::get_pending_wins() const {
+    return pending_wins;
+}
+
+/* Complexity: time: O(1), space: O(1)
+ */
+void Team::set_pending_wins(int wins) {
+    pending_wins = wins;
+}
+
 /* Complexity: time: O(1), space: O(1)
  */
 bool Team::isEmpty() const {
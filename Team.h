@@ -3,35 +3,76 @@
 
 #include "Pair.h"
 #include "Stack.h"
-#include "AVLTree.h"
+#include "AVLSet.h"
 
 typedef Pair Player;
 
+/* The undo record of a single add_player: the added player, and the median before it was added
+ * (Player() if that median is not known, e.g. for players that came from another team).
+ */
+class PlayerRecord {
+public:
+    Player player;
+    Player previous_median;
+    PlayerRecord() : player(), previous_median() {};
+    PlayerRecord(const Player& player, const Player& previous_median) :
+            player(player), previous_median(previous_median) {};
+};
+
 class Team {
 private:
+    static const int INLINE_CAPACITY = 16;
+    static const int DEMOTE_SIZE = INLINE_CAPACITY / 2;
+    // Unions of at least this many players flatten, merge and rebuild the players tree on all cores.
+    static const int PARALLEL_UNITE_SIZE = 1 << 16;
+
     int team_id;
-    Stack players_stack;
-    AVLTree<Player,std::nullptr_t> players_tree;
+    // Small teams keep their players inline: sorted by key, and by insertion order (oldest first).
+    // Once a team grows past INLINE_CAPACITY it moves to the stack and tree below, and moves back
+    // when it shrinks to DEMOTE_SIZE. Removals are LIFO, so the stack doubles as an undo log.
+    bool is_inline;
+    int inline_size;
+    Player inline_sorted[INLINE_CAPACITY];
+    Player inline_order[INLINE_CAPACITY];
+    Stack<PlayerRecord> players_stack;
+    AVLSet<Player> players_tree;
     Player median_player;
     int previous_wins;
+    // Match wins not yet added to the team's node in the teams rank tree (see olympics_t::flush_pending_wins).
+    int pending_wins;
 
     void update_median_in_insert(Player new_player);
     void update_median_in_erase(Player new_player);
+    void promote_to_tree();
+    void demote_to_inline();
+    Player pop_newest_player();
+    int insertPlayersInorderToArray(Player*& array, int num_threads) const;
+    void swap_players(Team& other) noexcept;
 
 public:
-    explicit Team(int team_id) : team_id(team_id), previous_wins(0) {};
+    // The players pool and undo stack of the team take their arrays from "arena" (or the heap if it is nullptr).
+    explicit Team(int team_id, BlockArena* arena = nullptr) : team_id(team_id), is_inline(true), inline_size(0),
+            players_stack(arena), players_tree(arena), previous_wins(0), pending_wins(0) {};
     /* ~Team() complexity: time: O(k), space: O(1) */
     ~Team() = default;
+    Team(const Team& other) = delete;
+    Team& operator=(const Team& other) = delete;
+    Team(Team&& other) noexcept;
+    Team& operator=(Team&& other) noexcept;
     int getSize() const;
     int getId() const;
     int get_strength() const;
     void add_player(int strength);
+    void add_players(const int* strengths, int count);
     void remove_newest_player();
     void unite_teams(Team& other_team);
+    void compact();
     Pair get_pair_key() const;
     bool isEmpty() const;
     int get_previous_wins() const;
     void set_previous_wins(int wins);
+    int get_pending_wins() const;
+    void set_pending_wins(int wins);
 };
 
 
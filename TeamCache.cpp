@@ -0,0 +1,67 @@
+#include "TeamCache.h"
+#include <cstdint>
+
+/* Complexity: time: O(1), space: O(1)
+ * Multiplies by 2^32 / golden ratio and keeps the top bits, so strided team ids are spread over the slots too.
+ */
+int TeamCache::slot(int team_id) {
+    return static_cast<int>((static_cast<uint32_t>(team_id) * 2654435769u) >> (32 - LOG_CAPACITY));
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Returns nullptr if the team is not in the cache.
+ */
+Team* TeamCache::find(int team_id) {
+    const Entry& entry = entries[slot(team_id)];
+    if (entry.team && entry.team_id == team_id) {
+        hits++;
+        return entry.team;
+    }
+    misses++;
+    return nullptr;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+void TeamCache::insert(int team_id, Team* team) {
+    Entry& entry = entries[slot(team_id)];
+    entry.team_id = team_id;
+    entry.team = team;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+void TeamCache::erase(int team_id) {
+    Entry& entry = entries[slot(team_id)];
+    if (entry.team_id == team_id) {
+        entry.team_id = 0;
+        entry.team = nullptr;
+    }
+}
+
+
+/* Complexity: time: O(1) (the cache has a fixed number of slots), space: O(1)
+ * Empties the cache (the hit and miss counters are kept).
+ */
+void TeamCache::clear() {
+    for (int i=0; i<CAPACITY; i++) {
+        entries[i] = Entry();
+    }
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+long long TeamCache::getHits() const {
+    return hits;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+long long TeamCache::getMisses() const {
+    return misses;
+}
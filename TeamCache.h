@@ -0,0 +1,39 @@
+#ifndef DS_WET2_TEAMCACHE_H
+#define DS_WET2_TEAMCACHE_H
+
+#include "Team.h"
+
+/* A small direct-mapped cache of teamId -> Team*, in front of the teams hash table.
+ * Every team id has a single slot (chosen by Fibonacci hashing), and a new team simply replaces the one in its slot.
+ * The cache does not own the teams: a team must be erased from the cache before it is deleted.
+ */
+class TeamCache {
+private:
+    static const int LOG_CAPACITY = 10;
+    static const int CAPACITY = 1 << LOG_CAPACITY;
+
+    class Entry {
+    public:
+        int team_id;
+        Team* team;
+        Entry() : team_id(0), team(nullptr) {};
+    };
+
+    Entry entries[CAPACITY];
+    long long hits;
+    long long misses;
+
+    static int slot(int team_id);
+
+public:
+    TeamCache() : hits(0), misses(0) {};
+    Team* find(int team_id);
+    void insert(int team_id, Team* team);
+    void erase(int team_id);
+    void clear();
+    long long getHits() const;
+    long long getMisses() const;
+};
+
+
+#endif //DS_WET2_TEAMCACHE_H
@@ -0,0 +1,190 @@
+#ifndef DS_WET2_TREEITERATOR_H
+#define DS_WET2_TREEITERATOR_H
+
+#include "NodePool.h"
+
+/* A non-recursive in-order iterator over a tree whose nodes live in a NodePool (AVLTree, RankTree and AVLSet).
+ * It keeps the path of nodes that are still to be visited on a fixed-size stack, so it needs no allocations, and
+ * walks forward (increasing keys) or in reverse (decreasing keys). The iterator is invalidated by any change to
+ * the tree. T is the type of the info of the nodes (void for trees without infos). The info is read through
+ * Node::infoOf, from the node itself or from an array of infos kept by the tree apart from its nodes.
+ */
+template<typename K, typename T, typename Node>
+class TreeIterator {
+private:
+    // An AVL tree of 2^32 nodes is less than 47 levels high.
+    static const int MAX_DEPTH = 64;
+
+    const NodePool<Node>* nodes;
+    T* const* infos;
+    NodeIndex path[MAX_DEPTH];
+    int depth;
+    bool reverse;
+
+    TreeIterator(const NodePool<Node>* nodes, T* const* infos, bool reverse) : nodes(nodes), infos(infos), depth(0),
+                                                                               reverse(reverse) {};
+    void pushSpine(NodeIndex node);
+
+public:
+    TreeIterator() : nodes(nullptr), infos(nullptr), depth(0), reverse(false) {};
+    static TreeIterator fromSubtree(const NodePool<Node>& nodes, NodeIndex root, bool reverse,
+                                    T* const* infos = nullptr);
+    static TreeIterator fromKey(const NodePool<Node>& nodes, NodeIndex root, const K& key, bool reverse,
+                                T* const* infos = nullptr);
+    static TreeIterator fromRank(const NodePool<Node>& nodes, NodeIndex root, int rank, bool reverse,
+                                 T* const* infos = nullptr);
+    bool isEnd() const;
+    NodeIndex node() const;
+    const K& key() const;
+    T* info() const;
+    TreeIterator& operator++();
+    bool operator==(const TreeIterator& other) const;
+    bool operator!=(const TreeIterator& other) const;
+};
+
+
+/* Complexity: time: O(log n), space: O(1)
+ * Pushes the node and its left sons (right sons in reverse), so the top of the stack is the first node of its
+ * subtree in the iteration order.
+ */
+template<typename K, typename T, typename Node>
+void TreeIterator<K, T, Node>::pushSpine(NodeIndex node) {
+    while (node != NIL) {
+        path[depth] = node;
+        depth++;
+        node = reverse ? (*nodes)[node].right : (*nodes)[node].left;
+    }
+}
+
+
+/* Complexity: time: O(log n), space: O(1)
+ * An iterator over the subtree of "root", starting at its smallest key (largest key in reverse).
+ */
+template<typename K, typename T, typename Node>
+TreeIterator<K, T, Node> TreeIterator<K, T, Node>::fromSubtree(const NodePool<Node>& nodes, NodeIndex root,
+                                                               bool reverse, T* const* infos) {
+    TreeIterator it(&nodes, infos, reverse);
+    it.pushSpine(root);
+    return it;
+}
+
+
+/* Complexity: time: O(log n), space: O(1)
+ * An iterator starting at the smallest key >= key (in reverse: at the largest key <= key).
+ */
+template<typename K, typename T, typename Node>
+TreeIterator<K, T, Node> TreeIterator<K, T, Node>::fromKey(const NodePool<Node>& nodes, NodeIndex root,
+                                                           const K& key, bool reverse, T* const* infos) {
+    TreeIterator it(&nodes, infos, reverse);
+    NodeIndex curr = root;
+    while (curr != NIL) {
+        bool in_range = reverse ? !(nodes[curr].key > key) : !(nodes[curr].key < key);
+        if (in_range) {
+            // The node is still to be visited, after the nodes on this side of it
+            it.path[it.depth] = curr;
+            it.depth++;
+            curr = reverse ? nodes[curr].right : nodes[curr].left;
+        }
+        else {
+            curr = reverse ? nodes[curr].left : nodes[curr].right;
+        }
+    }
+    return it;
+}
+
+
+/* Complexity: time: O(log n), space: O(1)
+ * An iterator starting at the key of the given rank (1 for the smallest key), which goes on to the larger keys
+ * (in reverse: to the smaller keys). The nodes must keep their subtree_size.
+ */
+template<typename K, typename T, typename Node>
+TreeIterator<K, T, Node> TreeIterator<K, T, Node>::fromRank(const NodePool<Node>& nodes, NodeIndex root,
+                                                            int rank, bool reverse, T* const* infos) {
+    TreeIterator it(&nodes, infos, reverse);
+    NodeIndex curr = root;
+    while (curr != NIL) {
+        NodeIndex left = nodes[curr].left;
+        int curr_rank = (left != NIL ? nodes[left].subtree_size : 0) + 1;
+        bool in_range = reverse ? curr_rank <= rank : curr_rank >= rank;
+        if (in_range) {
+            it.path[it.depth] = curr;
+            it.depth++;
+        }
+        if (curr_rank == rank) {
+            break;
+        }
+        if (rank < curr_rank) {
+            curr = left;
+        }
+        else {
+            rank -= curr_rank;
+            curr = nodes[curr].right;
+        }
+    }
+    return it;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename K, typename T, typename Node>
+bool TreeIterator<K, T, Node>::isEnd() const {
+    return depth == 0;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * The index of the current node in the tree's node pool.
+ */
+template<typename K, typename T, typename Node>
+NodeIndex TreeIterator<K, T, Node>::node() const {
+    return path[depth - 1];
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename K, typename T, typename Node>
+const K& TreeIterator<K, T, Node>::key() const {
+    return (*nodes)[path[depth - 1]].key;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+template<typename K, typename T, typename Node>
+T* TreeIterator<K, T, Node>::info() const {
+    return Node::infoOf(*nodes, infos, path[depth - 1]);
+}
+
+
+/* Complexity: time: O(log n) worst case, O(1) amortized over a whole iteration, space: O(1)
+ */
+template<typename K, typename T, typename Node>
+TreeIterator<K, T, Node>& TreeIterator<K, T, Node>::operator++() {
+    depth--;
+    NodeIndex node = path[depth];
+    pushSpine(reverse ? (*nodes)[node].left : (*nodes)[node].right);
+    return *this;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Iterators are equal if both ended, or both are at the same node.
+ */
+template<typename K, typename T, typename Node>
+bool TreeIterator<K, T, Node>::operator==(const TreeIterator& other) const {
+    if (depth == 0 || other.depth == 0) {
+        return depth == other.depth;
+    }
+    return path[depth - 1] == other.path[other.depth - 1];
+}
+
+
+template<typename K, typename T, typename Node>
+bool TreeIterator<K, T, Node>::operator!=(const TreeIterator& other) const {
+    return !(*this == other);
+}
+
+
+#endif //DS_WET2_TREEITERATOR_H
@@ -0,0 +1,70 @@
+#ifndef DS_WET2_BENCHUTIL_H
+#define DS_WET2_BENCHUTIL_H
+
+/* Shared helpers of the micro-benchmarks in this directory. Every benchmark takes an optional "scale" argument
+ * that multiplies its sizes (default 1), and every timing is the best of BENCH_REPEATS runs.
+ */
+#include "olympics24a2.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+static const int BENCH_REPEATS = 3;
+
+
+/* Complexity: time: O(1), space: O(1)
+ * A xorshift generator, so the benchmarks do not time rand().
+ */
+inline unsigned int nextRandom(unsigned int& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+inline double elapsedNs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * The scale given on the command line (argv[1]), or 0 after printing the usage if it is not a positive number.
+ */
+inline int parseScale(int argc, char** argv)
+{
+    int scale = (argc > 1) ? atoi(argv[1]) : 1;
+    if (scale <= 0) {
+        fprintf(stderr, "usage: %s [scale]\n", argv[0]);
+    }
+    return scale > 0 ? scale : 0;
+}
+
+
+/* Complexity: time: O(num_teams * roster), space: O(num_teams * roster)
+ * Loads teams 1..num_teams with "roster" players each into an empty olympics_t.
+ */
+inline void loadTeams(olympics_t& olympics, int num_teams, int roster, unsigned int& state)
+{
+    int* ids = new int[num_teams];
+    int* sizes = new int[num_teams];
+    int* strengths = new int[num_teams * roster];
+    for (int i = 0; i < num_teams; i++) {
+        ids[i] = i + 1;
+        sizes[i] = roster;
+    }
+    for (int i = 0; i < num_teams * roster; i++) {
+        strengths[i] = 1 + nextRandom(state) % 1000000;
+    }
+    olympics.load_season(num_teams, ids, sizes, strengths);
+    delete[] ids;
+    delete[] sizes;
+    delete[] strengths;
+}
+
+
+#endif //DS_WET2_BENCHUTIL_H
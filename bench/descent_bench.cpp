@@ -0,0 +1,127 @@
+/* Micro-benchmark of the rank tree descents (node layout and prefetching): the descents of a bare RankTree
+ * (get_num_wins, get_key_from_index and get_index_from_key), and num_wins_for_team lookups, one by one and batched
+ * through num_wins_for_teams.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 -Wall -pthread -I. -o descent_bench bench/descent_bench.cpp olympics24a2.cpp Team.cpp \
+ *       TeamCache.cpp
+ *   ./descent_bench [scale]
+ */
+#include "bench/BenchUtil.h"
+
+
+/* Complexity: time: O((num_teams + lookups) * log n), space: O(num_teams + lookups)
+ * Random num_wins_for_team lookups one by one, and the same lookups through num_wins_for_teams, on teams that have
+ * played random matches first.
+ */
+static void benchDescent(int scale)
+{
+    int num_teams = 4000000 * scale;
+    int lookups = 4000000 * scale;
+    unsigned int state = 99;
+    olympics_t olympics;
+    loadTeams(olympics, num_teams, 1, state);
+    int* teams = new int[lookups];
+    int* opponents = new int[lookups];
+    int* wins = new int[lookups];
+    StatusType* results = new StatusType[lookups];
+    // Give the teams some wins, so the descents add up "extra" on the way down
+    for (int i = 0; i < lookups; i++) {
+        teams[i] = 1 + nextRandom(state) % num_teams;
+        opponents[i] = 1 + nextRandom(state) % num_teams;
+    }
+    olympics.play_matches(teams, opponents, lookups, wins, results);
+    for (int i = 0; i < lookups; i++) {
+        teams[i] = 1 + nextRandom(state) % num_teams;
+    }
+    double single = 0;
+    double batched = 0;
+    long long total = 0;
+    for (int r = 0; r < BENCH_REPEATS; r++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int i = 0; i < lookups; i++) {
+            total += olympics.num_wins_for_team(teams[i]).ans();
+        }
+        double ns = elapsedNs(start) / lookups;
+        single = (r == 0 || ns < single) ? ns : single;
+
+        start = std::chrono::steady_clock::now();
+        olympics.num_wins_for_teams(teams, lookups, wins, results);
+        ns = elapsedNs(start) / lookups;
+        batched = (r == 0 || ns < batched) ? ns : batched;
+    }
+    printf("descent: num_wins_for_team           %8.1f ns/op  (total wins %lld)\n", single, total);
+    printf("descent: num_wins_for_teams          %8.1f ns/op\n", batched);
+    delete[] teams;
+    delete[] opponents;
+    delete[] wins;
+    delete[] results;
+}
+
+
+/* Complexity: time: O(n + lookups * log n), space: O(n + lookups)
+ * Random descents of a RankTree of n keys, without the team lookups around them.
+ */
+static void benchTreeDescents(int scale)
+{
+    int n = 4000000 * scale;
+    int lookups = 4000000 * scale;
+    unsigned int state = 7;
+    Pair* keys = new Pair[n];
+    Team** infos = new Team*[n];
+    Team team(1);
+    for (int i = 0; i < n; i++) {
+        keys[i] = Pair(i + 1, 1);
+        infos[i] = &team;
+    }
+    RankTree<Pair, Team> tree;
+    tree.buildFromSortedArray(keys, infos, n);
+    int* ranks = new int[lookups];
+    for (int i = 0; i < lookups; i++) {
+        ranks[i] = 1 + nextRandom(state) % n;
+    }
+    double wins_ns = 0;
+    double key_ns = 0;
+    double index_ns = 0;
+    long long total = 0;
+    for (int r = 0; r < BENCH_REPEATS; r++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int i = 0; i < lookups; i++) {
+            total += tree.get_num_wins(Pair(ranks[i], 1));
+        }
+        double ns = elapsedNs(start) / lookups;
+        wins_ns = (r == 0 || ns < wins_ns) ? ns : wins_ns;
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < lookups; i++) {
+            total += tree.get_key_from_index(ranks[i]).first;
+        }
+        ns = elapsedNs(start) / lookups;
+        key_ns = (r == 0 || ns < key_ns) ? ns : key_ns;
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < lookups; i++) {
+            total += tree.get_index_from_key(Pair(ranks[i], 1));
+        }
+        ns = elapsedNs(start) / lookups;
+        index_ns = (r == 0 || ns < index_ns) ? ns : index_ns;
+    }
+    printf("descent: RankTree::get_num_wins       %8.1f ns/op  (checksum %lld)\n", wins_ns, total);
+    printf("descent: RankTree::get_key_from_index %8.1f ns/op\n", key_ns);
+    printf("descent: RankTree::get_index_from_key %8.1f ns/op\n", index_ns);
+    delete[] keys;
+    delete[] infos;
+    delete[] ranks;
+}
+
+
+int main(int argc, char** argv)
+{
+    int scale = parseScale(argc, argv);
+    if (scale == 0) {
+        return 1;
+    }
+    benchTreeDescents(scale);
+    benchDescent(scale);
+    return 0;
+}
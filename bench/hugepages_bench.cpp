@@ -0,0 +1,67 @@
+/* Micro-benchmark of the huge page backed node pools (PageAllocator.h): rank tree lookups and updates with the
+ * node pools on 4K pages and on huge pages.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 -Wall -pthread -I. -o hugepages_bench bench/hugepages_bench.cpp olympics24a2.cpp Team.cpp \
+ *       TeamCache.cpp
+ *   ./hugepages_bench [scale]
+ */
+#include "bench/BenchUtil.h"
+#include "PageAllocator.h"
+
+
+/* Complexity: time: O(num_teams + lookups * log n), space: O(num_teams + lookups)
+ * Random num_wins_for_team lookups, and then random add_player calls (which re-key the teams in the rank tree).
+ */
+static void benchLookupsAndUpdates(int num_teams, int lookups, const char* label)
+{
+    unsigned int state = 4242;
+    olympics_t olympics;
+    loadTeams(olympics, num_teams, 1, state);
+    int* teams = new int[lookups];
+    for (int i = 0; i < lookups; i++) {
+        teams[i] = 1 + nextRandom(state) % num_teams;
+    }
+    double lookup_ns = 0;
+    for (int r = 0; r < BENCH_REPEATS; r++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int i = 0; i < lookups; i++) {
+            olympics.num_wins_for_team(teams[i]);
+        }
+        double ns = elapsedNs(start) / lookups;
+        lookup_ns = (r == 0 || ns < lookup_ns) ? ns : lookup_ns;
+    }
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < lookups; i++) {
+        olympics.add_player(teams[i], 1 + static_cast<int>(nextRandom(state) % 1000));
+    }
+    double update_ns = elapsedNs(start) / lookups;
+    printf("hugepages: %-4s num_wins_for_team     %8.1f ns/op\n", label, lookup_ns);
+    printf("hugepages: %-4s add_player            %8.1f ns/op\n", label, update_ns);
+    delete[] teams;
+}
+
+
+/* Complexity: time: O(num_teams + lookups * log n), space: O(num_teams + lookups)
+ */
+static void benchHugePages(int scale)
+{
+    int num_teams = 2000000 * scale;
+    int lookups = 2000000 * scale;
+    PageAllocator::setHugePages(false);
+    benchLookupsAndUpdates(num_teams, lookups, "4K");
+    PageAllocator::setHugePages(true);
+    benchLookupsAndUpdates(num_teams, lookups, "2M");
+    PageAllocator::setHugePages(false);
+}
+
+
+int main(int argc, char** argv)
+{
+    int scale = parseScale(argc, argv);
+    if (scale == 0) {
+        return 1;
+    }
+    benchHugePages(scale);
+    return 0;
+}
@@ -0,0 +1,77 @@
+/* Micro-benchmark of the AVX2 merge of distinct Pair keys (SimdMerge.h) against the scalar merge.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 -Wall -pthread -I. -o merge_bench bench/merge_bench.cpp olympics24a2.cpp Team.cpp TeamCache.cpp
+ *   ./merge_bench [scale]
+ */
+#include "bench/BenchUtil.h"
+
+
+/* Complexity: time: O(size), space: O(1)
+ * Two sorted arrays of distinct keys that interleave at random, like the players of two united teams.
+ */
+static void randomDistinctKeys(Pair* array_a, Pair* array_b, int size, unsigned int& state)
+{
+    int ia = 0, ib = 0;
+    for (int key = 1; ia < size || ib < size; key++) {
+        bool to_a = (ib == size) || (ia < size && (nextRandom(state) & 1));
+        if (to_a) {
+            array_a[ia++] = Pair(key, 1);
+        }
+        else {
+            array_b[ib++] = Pair(key, 1);
+        }
+    }
+}
+
+
+/* Complexity: time: O(size), space: O(size)
+ */
+static void benchMerge(int scale)
+{
+    int size = 4000000 * scale;
+    unsigned int state = 777;
+    Pair* array_a = new Pair[size];
+    Pair* array_b = new Pair[size];
+    Pair* merged = new Pair[2 * size];
+    randomDistinctKeys(array_a, array_b, size, state);
+    double scalar = 0;
+    for (int r = 0; r < BENCH_REPEATS; r++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        mergeDistinctKeys<Pair>(merged, array_a, size, array_b, size);
+        double ns = elapsedNs(start) / (2.0 * size);
+        scalar = (r == 0 || ns < scalar) ? ns : scalar;
+    }
+    printf("merge: scalar                        %8.2f ns/key\n", scalar);
+#ifdef SIMD_MERGE_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        double avx2 = 0;
+        for (int r = 0; r < BENCH_REPEATS; r++) {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            mergeDistinctPairsAVX2(merged, array_a, size, array_b, size);
+            double ns = elapsedNs(start) / (2.0 * size);
+            avx2 = (r == 0 || ns < avx2) ? ns : avx2;
+        }
+        printf("merge: AVX2                          %8.2f ns/key\n", avx2);
+    }
+    else {
+        printf("merge: AVX2                          (not supported by this CPU)\n");
+    }
+#else
+    printf("merge: AVX2                          (not built for this target)\n");
+#endif
+    delete[] array_a;
+    delete[] array_b;
+    delete[] merged;
+}
+
+
+int main(int argc, char** argv)
+{
+    int scale = parseScale(argc, argv);
+    if (scale == 0) {
+        return 1;
+    }
+    benchMerge(scale);
+    return 0;
+}
@@ -0,0 +1,52 @@
+/* Micro-benchmark of the undo log: add_player / remove_newest_player churn on inline teams and on tree teams.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 -Wall -pthread -I. -o undo_bench bench/undo_bench.cpp olympics24a2.cpp Team.cpp TeamCache.cpp
+ *   ./undo_bench [scale]
+ */
+#include "bench/BenchUtil.h"
+
+
+/* Complexity: time: O(ops * log k), space: O(num_teams * roster)
+ * Every step adds a player to a random team and then removes the newest player of another random team, so the
+ * rosters stay around "roster" players: inline for small rosters, in the players tree and undo log for big ones.
+ */
+static double benchChurn(int num_teams, int roster, int ops)
+{
+    unsigned int state = 12345;
+    olympics_t olympics;
+    loadTeams(olympics, num_teams, roster, state);
+    int* teams = new int[2 * ops];
+    int* strengths = new int[ops];
+    for (int i = 0; i < ops; i++) {
+        teams[2 * i] = 1 + nextRandom(state) % num_teams;
+        teams[2 * i + 1] = 1 + nextRandom(state) % num_teams;
+        strengths[i] = 1 + nextRandom(state) % 1000000;
+    }
+    double best = 0;
+    for (int r = 0; r < BENCH_REPEATS; r++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ops; i++) {
+            olympics.add_player(teams[2 * i], strengths[i]);
+            olympics.remove_newest_player(teams[2 * i + 1]);
+        }
+        double ns = elapsedNs(start) / (2.0 * ops);
+        best = (r == 0 || ns < best) ? ns : best;
+    }
+    delete[] teams;
+    delete[] strengths;
+    return best;
+}
+
+
+int main(int argc, char** argv)
+{
+    int scale = parseScale(argc, argv);
+    if (scale == 0) {
+        return 1;
+    }
+    int ops = 1000000 * scale;
+    printf("undo: inline teams (8 players)       %8.1f ns/op\n", benchChurn(1000 * scale, 8, ops));
+    printf("undo: tree teams (1000 players)      %8.1f ns/op\n", benchChurn(1000 * scale, 1000, ops));
+    return 0;
+}
@@ -1,16 +1,29 @@
 #include "olympics24a2.h"
+#include "SimdMatch.h"
+#include <fstream>
+#include <climits>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <system_error>
 
 
 /* Complexity: time: O(1), space: O(1)
  */
-olympics_t::olympics_t() {}
+olympics_t::olympics_t() : rank_snapshot_enabled(false), rank_snapshot_stale_reads(0), change_feed(nullptr),
+                           published_top(-1) {}
 
 
-/* Complexity: time: O(n+k) worst case, space: O(1) amortized on average
+/* Complexity: time: O(c) for c chunks of teams_arena and players_arena, space: O(1)
+ * The teams own no memory outside of players_arena, so teams_arena releases its chunks without running their
+ * destructors, and then players_arena releases all the players pools and stacks at once (when it is destroyed).
+ * The other members free one array each (teams_hash frees one small node pool per bucket once it has moved to
+ * its hash table).
  */
 olympics_t::~olympics_t()
 {
-    teams_hash.deAllocateAllInfo();
+    teams_arena.release();
+    delete change_feed;
 }
 
 
@@ -21,19 +34,23 @@ StatusType olympics_t::add_team(int teamId)
 	if (teamId <= 0) {
         return StatusType::INVALID_INPUT;
     }
-    if(teams_hash.find(teamId)){
+    if(find_team(teamId)){
         return StatusType::FAILURE;
     }
     try {
-        Team *new_team = new Team(teamId);
-        if (!new_team) {
-            return StatusType::ALLOCATION_ERROR;
+        Team *new_team = teams_arena.create(teamId, &players_arena);
+        try {
+            teams_hash.insert(teamId, new_team);
+        }
+        catch (const std::bad_alloc&) {
+            teams_arena.destroy(new_team);
+            throw;
         }
-        teams_hash.insert(teamId, new_team);
     }
     catch(const std::bad_alloc&) {
         return StatusType::ALLOCATION_ERROR;
     }
+    publish_top();
     return StatusType::SUCCESS;
 }
 
@@ -45,18 +62,22 @@ StatusType olympics_t::remove_team(int teamId)
     if(teamId<=0){
         return StatusType::INVALID_INPUT;
     }
-    Team* removed_team = teams_hash.find(teamId);
+    Team* removed_team = find_team(teamId);
     if(!removed_team){
         return StatusType::FAILURE;
     }
     try{
+        team_cache.erase(teamId);
         teams_hash.erase(teamId);
         teams_rank_tree.erase(removed_team->get_pair_key());
-        delete removed_team;
     }
     catch (const std::bad_alloc&) {
         return StatusType::ALLOCATION_ERROR;
     }
+    // Does not throw, so the team can not be left unlinked but alive:
+    teams_arena.destroy(removed_team);
+    publish(RankEventType::TEAM_REMOVED, teamId, 0, 0);
+    publish_top();
 	return StatusType::SUCCESS;
 }
 
@@ -69,7 +90,7 @@ StatusType olympics_t::add_player(int teamId, int playerStrength)
         return StatusType::INVALID_INPUT;
     }
 
-    Team* team = teams_hash.find(teamId);
+    Team* team = find_team(teamId);
     if (!team) {
         // Team doesn't exist
         return StatusType::FAILURE;
@@ -78,7 +99,7 @@ StatusType olympics_t::add_player(int teamId, int playerStrength)
     int wins = 0;
     if (team->getSize() > 0) {
         // Remove the team from the teams rank tree (and save the amount of wins the team has):
-        wins = teams_rank_tree.get_num_wins(team->get_pair_key());
+        wins = take_team_wins(team);
         teams_rank_tree.erase(team->get_pair_key());
     }
     else {
@@ -93,10 +114,64 @@ StatusType olympics_t::add_player(int teamId, int playerStrength)
     // Re-add the team to the teams rank tree (and re-add the wins)
     teams_rank_tree.insert(team->get_pair_key(), team);
     teams_rank_tree.add_wins_in_range(team->get_pair_key(), team->get_pair_key(), wins);
+    publish(RankEventType::TEAM_REKEYED, teamId, 0, team->get_strength());
+    publish_top();
 	return StatusType::SUCCESS;
 }
 
 
+/* Complexity: time: O( log n + k + m log m ) worst case
+ * Adds m players to the team, re-keying the team in the teams rank tree only once.
+ */
+StatusType olympics_t::add_players(int teamId, const int* playerStrengths, int count)
+{
+    if (teamId <= 0 || count < 0 || (count > 0 && !playerStrengths)) {
+        return StatusType::INVALID_INPUT;
+    }
+    for (int i=0; i<count; i++) {
+        if (playerStrengths[i] <= 0) {
+            return StatusType::INVALID_INPUT;
+        }
+    }
+
+    Team* team = find_team(teamId);
+    if (!team) {
+        // Team doesn't exist
+        return StatusType::FAILURE;
+    }
+    if (count == 0) {
+        return StatusType::SUCCESS;
+    }
+
+    try {
+        int wins = 0;
+        if (team->getSize() > 0) {
+            // Remove the team from the teams rank tree (and save the amount of wins the team has):
+            wins = take_team_wins(team);
+            teams_rank_tree.erase(team->get_pair_key());
+        }
+        else {
+            // If team is empty, use the previous number of wins from the team and reset previous_wins
+            wins = team->get_previous_wins();
+            team->set_previous_wins(0);
+        }
+
+        // Add the players to the team:
+        team->add_players(playerStrengths, count);
+
+        // Re-add the team to the teams rank tree (and re-add the wins)
+        teams_rank_tree.insert(team->get_pair_key(), team);
+        teams_rank_tree.add_wins_in_range(team->get_pair_key(), team->get_pair_key(), wins);
+    }
+    catch (const std::bad_alloc&) {
+        return StatusType::ALLOCATION_ERROR;
+    }
+    publish(RankEventType::TEAM_REKEYED, teamId, 0, team->get_strength());
+    publish_top();
+    return StatusType::SUCCESS;
+}
+
+
 /* Complexity: time: O( log n + log k ) worst case
  */
 StatusType olympics_t::remove_newest_player(int teamId)
@@ -105,14 +180,14 @@ StatusType olympics_t::remove_newest_player(int teamId)
         return StatusType::INVALID_INPUT;
     }
 
-    Team* team = teams_hash.find(teamId);
+    Team* team = find_team(teamId);
     if (!team || team->getSize() == 0) {
         // Team doesn't exist or is empty
         return StatusType::FAILURE;
     }
 
     // Remove the team from the teams rank tree (and save the amount of wins the team has):
-    int wins = teams_rank_tree.get_num_wins(team->get_pair_key());
+    int wins = take_team_wins(team);
     teams_rank_tree.erase(team->get_pair_key());
 
     // Remove the player:
@@ -126,42 +201,50 @@ StatusType olympics_t::remove_newest_player(int teamId)
     else {
         team->set_previous_wins(wins);
     }
+    publish(RankEventType::TEAM_REKEYED, teamId, 0, team->get_strength());
+    publish_top();
 	return StatusType::SUCCESS;
 }
 
 
-/* Complexity: time: O(log n) worst case
+/* Complexity: time: O(1) on average
+ * The win is only buffered in the winning team (see flush_pending_wins).
  */
 output_t<int> olympics_t::play_match(int teamId1, int teamId2)
 {
     if(teamId1<=0 || teamId2<=0 || teamId1 == teamId2){
         return StatusType::INVALID_INPUT;
     }
-    Team* team1 = teams_hash.find(teamId1);
-    Team* team2 = teams_hash.find(teamId2);
+    Team* team1 = find_team(teamId1);
+    Team* team2 = find_team(teamId2);
     if(!team1 || !team2 || team1->isEmpty() || team2->isEmpty()){
         return StatusType::FAILURE;
     }
     int first_score, second_score;
     first_score = team1->get_strength();
     second_score = team2->get_strength();
-    if(first_score > second_score){
-        teams_rank_tree.add_wins_in_range(team1->get_pair_key(), team1->get_pair_key(), 1);
-        return teamId1;
-    }
-    else if(first_score < second_score){
-        teams_rank_tree.add_wins_in_range(team2->get_pair_key(), team2->get_pair_key(), 1);
-        return teamId2;
-    }
-    else{  //(first_score == second_score)
-        if(teamId1 < teamId2){
-            teams_rank_tree.add_wins_in_range(team1->get_pair_key(), team1->get_pair_key(), 1);
+    try {
+        if(first_score > second_score){
+            add_pending_win(team1);
             return teamId1;
         }
-        else{
-            teams_rank_tree.add_wins_in_range(team2->get_pair_key(), team2->get_pair_key(), 1);
+        else if(first_score < second_score){
+            add_pending_win(team2);
             return teamId2;
         }
+        else{  //(first_score == second_score)
+            if(teamId1 < teamId2){
+                add_pending_win(team1);
+                return teamId1;
+            }
+            else{
+                add_pending_win(team2);
+                return teamId2;
+            }
+        }
+    }
+    catch (const std::bad_alloc&) {
+        return StatusType::ALLOCATION_ERROR;
     }
 }
 
@@ -174,7 +257,7 @@ output_t<int> olympics_t::num_wins_for_team(int teamId)
         return StatusType::INVALID_INPUT;
     }
 
-    Team* team = teams_hash.find(teamId);
+    Team* team = find_team(teamId);
     if (!team) {
         // Team doesn't exist
         return StatusType::FAILURE;
@@ -183,11 +266,14 @@ output_t<int> olympics_t::num_wins_for_team(int teamId)
     if (team->getSize() == 0) {
         return team->get_previous_wins();
     }
-    return teams_rank_tree.get_num_wins(team->get_pair_key());;
+    if (use_rank_snapshot()) {
+        return rank_snapshot.get_num_wins(team->get_pair_key()) + team->get_pending_wins();
+    }
+    return teams_rank_tree.get_num_wins(team->get_pair_key()) + team->get_pending_wins();
 }
 
 
-/* Complexity: time: O(1) worst case
+/* Complexity: time: O(p log n) on average for p teams with pending wins, O(1) if there are none
  */
 output_t<int> olympics_t::get_highest_ranked_team()
 {
@@ -197,6 +283,7 @@ output_t<int> olympics_t::get_highest_ranked_team()
     if(teams_rank_tree.isEmpty()){
         return 0;
     }
+    flush_pending_wins();
 	return teams_rank_tree.get_max_rank();
 }
 
@@ -208,8 +295,8 @@ StatusType olympics_t::unite_teams(int teamId1, int teamId2)
     if (teamId1 <= 0 || teamId2 <= 0 || teamId1 == teamId2) {
         return StatusType::INVALID_INPUT;
     }
-    Team* team1 = teams_hash.find(teamId1);
-    Team* team2 = teams_hash.find(teamId2);
+    Team* team1 = find_team(teamId1);
+    Team* team2 = find_team(teamId2);
     if (!team1 || !team2) {
         return StatusType::FAILURE;
     }
@@ -218,7 +305,7 @@ StatusType olympics_t::unite_teams(int teamId1, int teamId2)
     int wins = 0;
     if (team1->getSize() > 0) {
         // Remove the team from the teams rank tree (and save the amount of wins the team has):
-        wins = teams_rank_tree.get_num_wins(team1->get_pair_key());
+        wins = take_team_wins(team1);
         teams_rank_tree.erase(team1->get_pair_key());
     }
     else {
@@ -239,6 +326,7 @@ StatusType olympics_t::unite_teams(int teamId1, int teamId2)
     else {
         team1->set_previous_wins(wins);
     }
+    publish(RankEventType::TEAM_REKEYED, teamId1, 0, team1->get_strength());
 
     // Remove team2 from olympics
     remove_team(teamId2);
@@ -263,17 +351,36 @@ output_t<int> olympics_t::play_tournament(int lowPower, int highPower)
         return StatusType::INVALID_INPUT;
     }
 
-    // Find the lowest key in which strength >= lowPower, and the highest key in which  strength <= highPower
-    Pair low_team_key = teams_rank_tree.getNextKey(Pair(lowPower-1, -1));
-    Pair high_team_key = teams_rank_tree.getPrevKey(Pair(highPower, -1));
-
-    if (low_team_key == Pair() || high_team_key == Pair()) {
-        return StatusType::FAILURE;
+    // Adding wins does not change the keys or their indexes, so a snapshot that is up to date now answers all the
+    // index lookups of the tournament.
+    bool from_snapshot = use_rank_snapshot();
+    Pair low_team_key;
+    Pair high_team_key;
+    int low_index;
+    int high_index;
+    if (from_snapshot) {
+        // No team id is -1, so the indexes around Pair(power, -1) are those of the keys below and above it
+        low_index = rank_snapshot.get_lower_bound_index(Pair(lowPower-1, -1));
+        high_index = rank_snapshot.get_lower_bound_index(Pair(highPower, -1)) - 1;
+        if (low_index > rank_snapshot.getSize() || high_index < 1) {
+            return StatusType::FAILURE;
+        }
+        low_team_key = rank_snapshot.get_key_from_index(low_index);
+        high_team_key = rank_snapshot.get_key_from_index(high_index);
     }
+    else {
+        // Find the lowest key in which strength >= lowPower, and the highest key in which  strength <= highPower
+        low_team_key = teams_rank_tree.getNextKey(Pair(lowPower-1, -1));
+        high_team_key = teams_rank_tree.getPrevKey(Pair(highPower, -1));
 
-    // Get indexes of low and high teams in tournament:
-    int low_index = teams_rank_tree.get_index_from_key(low_team_key);
-    int high_index = teams_rank_tree.get_index_from_key(high_team_key);
+        if (low_team_key == Pair() || high_team_key == Pair()) {
+            return StatusType::FAILURE;
+        }
+
+        // Get indexes of low and high teams in tournament:
+        low_index = teams_rank_tree.get_index_from_key(low_team_key);
+        high_index = teams_rank_tree.get_index_from_key(high_team_key);
+    }
     int count_teams_in_tournament = high_index - low_index + 1;
     if (low_index > high_index || low_index < 1 || high_index > teams_rank_tree.getSize() ||
         !power_of_two(count_teams_in_tournament)) {
@@ -281,14 +388,948 @@ output_t<int> olympics_t::play_tournament(int lowPower, int highPower)
         return StatusType::FAILURE;
     }
 
-    // Run for log(count_teams_in_tournament) iterations, each add a win to all teams between median and high,
-    // And update low to be the median
+    // Run for log(count_teams_in_tournament) rounds, each add a win to all teams between median and high,
+    // And update low to be the median. The rounds do not move keys, so all of them are added in a single pass.
+    RankTree<Pair, Team>::RangeWins rounds[32];
+    int num_rounds = 0;
     for (int i=1; i<=log2(count_teams_in_tournament); i++) {
         int mid = (high_index - low_index + 1) / 2 + low_index;
-        Pair mid_team_key = teams_rank_tree.get_key_from_index(mid);
-        teams_rank_tree.add_wins_in_range(mid_team_key, high_team_key, 1);
+        Pair mid_team_key = from_snapshot ? rank_snapshot.get_key_from_index(mid) :
+                            teams_rank_tree.get_key_from_index(mid);
+        rounds[num_rounds] = RankTree<Pair, Team>::RangeWins(mid_team_key, high_team_key, 1);
+        num_rounds++;
         low_index = mid;
     }
+    try {
+        teams_rank_tree.add_wins_in_ranges(rounds, num_rounds);
+    }
+    catch (const std::bad_alloc&) {
+        // Add the rounds one by one (this does not allocate)
+        for (int i=0; i<num_rounds; i++) {
+            teams_rank_tree.add_wins_in_range(rounds[i].min_key, rounds[i].max_key, rounds[i].wins);
+        }
+    }
+    for (int i=0; i<num_rounds; i++) {
+        publish(RankEventType::RANGE_WINS_ADDED, rounds[i].min_key.second, rounds[i].max_key.second,
+                rounds[i].wins);
+    }
+    publish_top();
 
     return high_team_key.second; // Return the winning team id
 }
+
+
+/* Complexity: time: O(n) worst case, space: O(1)
+ * Removes all the teams (and their players).
+ */
+void olympics_t::clear_season()
+{
+    teams_arena.release();
+    players_arena.clear();
+    teams_hash = IdTable<Team>();
+    teams_rank_tree = RankTree<Pair, Team>();
+    pending_win_teams = Stack<int>();
+    team_cache.clear();
+    rank_snapshot.clear();
+}
+
+
+/* Complexity: time: O(1) on average
+ * Looks the team up in the team cache, and on a miss in teams_hash (caching the team if it exists).
+ * If the team doesn't exist, returns nullptr.
+ */
+Team* olympics_t::find_team(int teamId)
+{
+    Team* team = team_cache.find(teamId);
+    if (!team) {
+        team = teams_hash.find(teamId);
+        if (team) {
+            team_cache.insert(teamId, team);
+        }
+    }
+    return team;
+}
+
+
+/* Complexity: time: O(1) amortized on average for bursts of matches between the same teams, O(log n) otherwise
+ * Buffers a match win of a team that is in the teams rank tree: the wins reach the tree only when they are needed.
+ * While the change feed is enabled the win goes straight to the tree (O(log n)), so a match that changes the
+ * highest rank publishes TOP_CHANGED at once.
+ */
+void olympics_t::add_pending_win(Team* team)
+{
+    if (change_feed) {
+        teams_rank_tree.add_wins_in_range(team->get_pair_key(), team->get_pair_key(), 1);
+        publish(RankEventType::WINS_CHANGED, team->getId(), 0, 1);
+        publish_top();
+        return;
+    }
+    if (team->get_pending_wins() == 0) {
+        if (pending_win_teams.getSize() >= teams_rank_tree.getSize()) {
+            // Keep the buffer at most as long as the number of teams
+            flush_pending_wins();
+        }
+        pending_win_teams.push(team->getId());
+    }
+    team->set_pending_wins(team->get_pending_wins() + 1);
+    publish(RankEventType::WINS_CHANGED, team->getId(), 0, 1);
+}
+
+
+/* Complexity: time: O(p log n) on average, for p teams in pending_win_teams
+ * Adds the pending wins of all the teams to the teams rank tree.
+ * Teams that were removed, or whose wins were already taken by take_team_wins, are skipped.
+ */
+void olympics_t::flush_pending_wins()
+{
+    while (!pending_win_teams.isEmpty()) {
+        Team* team = find_team(pending_win_teams.pop());
+        if (team && team->get_pending_wins() != 0) {
+            teams_rank_tree.add_wins_in_range(team->get_pair_key(), team->get_pair_key(), team->get_pending_wins());
+            team->set_pending_wins(0);
+        }
+    }
+    publish_top();
+}
+
+
+/* Complexity: time: O(log n) worst case
+ * Returns the wins of a team that is in the teams rank tree (including its pending wins), before it is re-keyed.
+ * The pending wins are cleared, as the caller re-adds all the wins with the new key.
+ */
+int olympics_t::take_team_wins(Team* team)
+{
+    int wins = teams_rank_tree.get_num_wins(team->get_pair_key()) + team->get_pending_wins();
+    team->set_pending_wins(0);
+    return wins;
+}
+
+
+/* Complexity: time: O(1), or O(n) amortized over the reads that waited for the snapshot when it is rebuilt
+ * Whether the reads of teams_rank_tree (wins and indexes, not pending wins) may be answered by rank_snapshot.
+ * Every update of the tree makes the snapshot stale. A stale snapshot is rebuilt once n/2^RANK_SNAPSHOT_REBUILD_SHIFT
+ * reads went to the tree instead, so a read-heavy phase soon gets a fresh snapshot, and a phase that keeps
+ * updating the tree pays O(1) per read for the rebuilds. If the rebuild fails to allocate, the tree answers.
+ */
+bool olympics_t::use_rank_snapshot()
+{
+    if (!rank_snapshot_enabled) {
+        return false;
+    }
+    if (rank_snapshot.isUpToDate(teams_rank_tree)) {
+        return true;
+    }
+    rank_snapshot_stale_reads++;
+    if (rank_snapshot_stale_reads <= (teams_rank_tree.getSize() >> RANK_SNAPSHOT_REBUILD_SHIFT)) {
+        return false;
+    }
+    rank_snapshot_stale_reads = 0;
+    try {
+        rank_snapshot.build(teams_rank_tree);
+    }
+    catch (const std::bad_alloc&) {
+        return false;
+    }
+    return true;
+}
+
+
+/* Complexity: time: O(num_threads) for starting the threads, space: O(num_threads)
+ * Runs "worker" on num_threads threads - the calling thread and num_threads-1 new ones - and waits for all of
+ * them. The workers are expected to take their work from a shared counter, and must not throw: if a thread can
+ * not be started (std::system_error or std::bad_alloc), the work is simply left to the threads that did start.
+ */
+template<typename Worker>
+void run_workers(int num_threads, Worker& worker)
+{
+    std::thread* threads = nullptr;
+    int started = 0;
+    if (num_threads > 1) {
+        try {
+            threads = new std::thread[num_threads - 1];
+            for (; started < num_threads - 1; started++) {
+                threads[started] = std::thread(std::ref(worker));
+            }
+        }
+        catch (const std::system_error&) {
+        }
+        catch (const std::bad_alloc&) {
+        }
+    }
+    worker();
+    for (int i=0; i<started; i++) {
+        threads[i].join();
+    }
+    delete[] threads;
+}
+
+
+/* Complexity: time: O(n log n + k log k) worst case, O(n log n + (k log k) / num_threads) for large seasons
+ * Loads a whole season into an empty olympics_t: team teamIds[i] gets rosterSizes[i] players, whose strengths are
+ * the next rosterSizes[i] entries of playerStrengths (in the order they join the team).
+ * All teams start with 0 wins. If any input is invalid, nothing is loaded.
+ * The teams are created one by one, and then (for at least PARALLEL_LOAD_PLAYERS players) their rosters are
+ * built by all the cores, each thread taking the next team from a shared counter.
+ */
+StatusType olympics_t::load_season(int numTeams, const int* teamIds, const int* rosterSizes,
+                                   const int* playerStrengths)
+{
+    if (numTeams < 0 || (numTeams > 0 && (!teamIds || !rosterSizes))) {
+        return StatusType::INVALID_INPUT;
+    }
+    int total_players = 0;
+    for (int i=0; i<numTeams; i++) {
+        if (teamIds[i] <= 0 || rosterSizes[i] < 0 || rosterSizes[i] > INT_MAX - total_players) {
+            return StatusType::INVALID_INPUT;
+        }
+        total_players += rosterSizes[i];
+    }
+    if (total_players > 0 && !playerStrengths) {
+        return StatusType::INVALID_INPUT;
+    }
+    for (int i=0; i<total_players; i++) {
+        if (playerStrengths[i] <= 0) {
+            return StatusType::INVALID_INPUT;
+        }
+    }
+    if (!teams_hash.isEmpty()) {
+        return StatusType::FAILURE;
+    }
+
+    Pair* keys = nullptr;
+    Team** teams = nullptr;
+    int* offsets = nullptr;
+    try {
+        // Create all the teams, with the hash table pre-sized for them:
+        teams_hash.reserve(numTeams);
+        keys = new Pair[numTeams];
+        teams = new Team*[numTeams];
+        offsets = new int[numTeams];
+        int offset = 0;
+        for (int i=0; i<numTeams; i++) {
+            if (teams_hash.find(teamIds[i])) {
+                // The same team appears twice
+                delete[] keys;
+                delete[] teams;
+                delete[] offsets;
+                clear_season();
+                return StatusType::INVALID_INPUT;
+            }
+            Team* team = teams_arena.create(teamIds[i], &players_arena);
+            try {
+                teams_hash.insert(teamIds[i], team);
+            }
+            catch (const std::bad_alloc&) {
+                teams_arena.destroy(team);
+                throw;
+            }
+            teams[i] = team;
+            offsets[i] = offset;
+            offset += rosterSizes[i];
+        }
+
+        // Build the rosters (every team only touches its own players):
+        std::atomic<int> next_team(0);
+        std::atomic<bool> failed(false);
+        auto worker = [&]() {
+            for (int i = next_team++; i < numTeams && !failed; i = next_team++) {
+                try {
+                    teams[i]->add_players(playerStrengths + offsets[i], rosterSizes[i]);
+                }
+                catch (const std::bad_alloc&) {
+                    failed = true;
+                }
+            }
+        };
+        int num_threads = 1;
+        if (total_players >= PARALLEL_LOAD_PLAYERS && numTeams > 1) {
+            num_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        }
+        run_workers(num_threads, worker);
+        if (failed) {
+            throw std::bad_alloc();
+        }
+
+        // Build the teams rank tree bottom-up from the non-empty teams sorted by key:
+        int count_keys = 0;
+        for (int i=0; i<numTeams; i++) {
+            if (teams[i]->getSize() > 0) {
+                keys[count_keys] = teams[i]->get_pair_key();
+                count_keys++;
+            }
+        }
+        sortKeys(keys, count_keys);
+        for (int i=0; i<count_keys; i++) {
+            teams[i] = teams_hash.find(keys[i].second);
+        }
+        teams_rank_tree.buildFromSortedArray(keys, teams, count_keys);
+        for (int i=0; i<count_keys; i++) {
+            publish(RankEventType::TEAM_REKEYED, keys[i].second, 0, keys[i].first);
+        }
+        publish_top();
+    }
+    catch (const std::bad_alloc&) {
+        delete[] keys;
+        delete[] teams;
+        delete[] offsets;
+        clear_season();
+        return StatusType::ALLOCATION_ERROR;
+    }
+    delete[] keys;
+    delete[] teams;
+    delete[] offsets;
+    return StatusType::SUCCESS;
+}
+
+
+/* Complexity: time: the same as load_season, space: O(n + k)
+ * Loads a season from a roster file into an empty olympics_t. Every team is written as
+ * "teamId rosterSize strength_1 ... strength_rosterSize", separated by whitespace.
+ * A file that is not made of whole records (e.g. ends in the middle of one) is INVALID_INPUT.
+ */
+StatusType olympics_t::load_roster_file(const char* path)
+{
+    if (!path) {
+        return StatusType::INVALID_INPUT;
+    }
+    std::ifstream file(path);
+    if (!file) {
+        return StatusType::FAILURE;
+    }
+
+    // First pass: count the teams and the players
+    int num_teams = 0, total_players = 0;
+    int team_id, roster_size, strength;
+    while (file >> team_id) {
+        // A team id must be followed by a roster size (and a total of at most INT_MAX players)
+        if (!(file >> roster_size) || roster_size < 0 || roster_size > INT_MAX - total_players) {
+            return StatusType::INVALID_INPUT;
+        }
+        for (int i=0; i<roster_size; i++) {
+            if (!(file >> strength)) {
+                return StatusType::INVALID_INPUT;
+            }
+        }
+        num_teams++;
+        total_players += roster_size;
+    }
+    if (!file.eof()) {
+        return StatusType::INVALID_INPUT;
+    }
+
+    // Second pass: read the rosters into arrays
+    file.clear();
+    file.seekg(0);
+    int* team_ids = nullptr;
+    int* roster_sizes = nullptr;
+    int* strengths = nullptr;
+    StatusType result;
+    try {
+        team_ids = new int[num_teams];
+        roster_sizes = new int[num_teams];
+        strengths = new int[total_players];
+        int offset = 0;
+        for (int i=0; i<num_teams; i++) {
+            file >> team_ids[i] >> roster_sizes[i];
+            for (int j=0; j<roster_sizes[i]; j++, offset++) {
+                file >> strengths[offset];
+            }
+        }
+        result = load_season(num_teams, team_ids, roster_sizes, strengths);
+    }
+    catch (const std::bad_alloc&) {
+        result = StatusType::ALLOCATION_ERROR;
+    }
+    delete[] team_ids;
+    delete[] roster_sizes;
+    delete[] strengths;
+    return result;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+static bool is_valid_command(const PlayerCommand& command)
+{
+    return command.team_id > 0 && (!command.is_add || command.strength > 0);
+}
+
+
+/* Complexity: time: O(m log m + t log n + sum of the per-team work), space: O(m + t)
+ * Applies a batch of m add_player / remove_newest_player commands, touching t teams, and writes the status of
+ * every command to results[i] - exactly as if the commands were run one by one.
+ * Each touched team is taken out of the teams rank tree once before the batch and put back once after it, and
+ * in between the commands of different teams are independent, so the teams are updated by "num_threads" threads.
+ * Everything that may fail to allocate before the teams are taken out is allocated first: if it fails, every
+ * invalid command gets INVALID_INPUT, every valid one gets ALLOCATION_ERROR, and nothing changes. After that,
+ * a command whose own allocation fails gets ALLOCATION_ERROR, and the teams are always put back (into tree nodes
+ * reserved up front).
+ */
+void olympics_t::apply_player_commands(const PlayerCommand* commands, int count, StatusType* results,
+                                       int num_threads)
+{
+    Pair* order = nullptr;
+    int* group_start = nullptr;
+    Team** teams = nullptr;
+    int* wins = nullptr;
+    int count_valid = 0;
+    int count_groups = 0;
+    try {
+        // Sort the valid commands by team, keeping the order of the commands inside every team:
+        // order[j] = (team_id, -i) for command i, since pairs with equal "first" are sorted by decreasing "second".
+        order = new Pair[count];
+        for (int i=0; i<count; i++) {
+            if (!is_valid_command(commands[i])) {
+                results[i] = StatusType::INVALID_INPUT;
+            }
+            else {
+                order[count_valid] = Pair(commands[i].team_id, -i);
+                count_valid++;
+            }
+        }
+        sortKeys(order, count_valid);
+
+        // Find the range of commands of every team:
+        group_start = new int[count_valid + 1];
+        for (int j=0; j<count_valid; j++) {
+            if (j == 0 || order[j].first != order[j-1].first) {
+                group_start[count_groups] = j;
+                count_groups++;
+            }
+        }
+        group_start[count_groups] = count_valid;
+
+        teams = new Team*[count_groups];
+        wins = new int[count_groups];
+        // Every touched team may come back to the tree, even the ones that are not in it now:
+        teams_rank_tree.reserveInserts(count_groups);
+    }
+    catch (const std::bad_alloc&) {
+        // "order" may not exist, so every result is written from the commands themselves:
+        for (int i=0; i<count; i++) {
+            results[i] = is_valid_command(commands[i]) ? StatusType::ALLOCATION_ERROR : StatusType::INVALID_INPUT;
+        }
+        delete[] order;
+        delete[] group_start;
+        delete[] teams;
+        delete[] wins;
+        return;
+    }
+
+    // Take every touched team out of the teams rank tree (and save the amount of wins it has):
+    for (int g=0; g<count_groups; g++) {
+        teams[g] = find_team(order[group_start[g]].first);
+        if (!teams[g]) {
+            continue;
+        }
+        if (teams[g]->getSize() > 0) {
+            wins[g] = take_team_wins(teams[g]);
+            teams_rank_tree.erase(teams[g]->get_pair_key());
+        }
+        else {
+            wins[g] = teams[g]->get_previous_wins();
+        }
+    }
+
+    // Run the commands of every team, with the threads taking the next team to update from a shared counter
+    // (apply_team_commands does not throw):
+    std::atomic<int> next_group(0);
+    auto worker = [&]() {
+        for (int g = next_group++; g < count_groups; g = next_group++) {
+            apply_team_commands(commands, order, group_start[g], group_start[g+1], results);
+        }
+    };
+    run_workers((count_groups > 1) ? num_threads : 1, worker);
+
+    // Put every touched team back to the teams rank tree (and re-add the wins):
+    for (int g=0; g<count_groups; g++) {
+        if (!teams[g]) {
+            continue;
+        }
+        if (teams[g]->getSize() > 0) {
+            teams[g]->set_previous_wins(0);
+            teams_rank_tree.insert(teams[g]->get_pair_key(), teams[g]);
+            teams_rank_tree.add_wins_in_range(teams[g]->get_pair_key(), teams[g]->get_pair_key(), wins[g]);
+        }
+        else {
+            teams[g]->set_previous_wins(wins[g]);
+        }
+        publish(RankEventType::TEAM_REKEYED, teams[g]->getId(), 0, teams[g]->get_strength());
+    }
+    publish_top();
+
+    delete[] order;
+    delete[] group_start;
+    delete[] teams;
+    delete[] wins;
+}
+
+
+/* Complexity: time: O(c log k), space: O(log k)
+ * Runs the commands order[low..high-1] of a single team (which is out of the teams rank tree).
+ * Only touches that team, so it may run in parallel for different teams. Never throws: an add_player that fails
+ * to allocate gets ALLOCATION_ERROR, since an exception must not leave a worker thread.
+ */
+void olympics_t::apply_team_commands(const PlayerCommand* commands, const Pair* order, int low, int high,
+                                     StatusType* results)
+{
+    // Not find_team: this runs in parallel, and only reads teams_hash.
+    Team* team = teams_hash.find(order[low].first);
+    for (int j=low; j<high; j++) {
+        int i = -order[j].second;
+        if (!team) {
+            // Team doesn't exist
+            results[i] = StatusType::FAILURE;
+        }
+        else if (commands[i].is_add) {
+            try {
+                team->add_player(commands[i].strength);
+                results[i] = StatusType::SUCCESS;
+            }
+            catch (const std::bad_alloc&) {
+                results[i] = StatusType::ALLOCATION_ERROR;
+            }
+        }
+        else if (team->getSize() == 0) {
+            results[i] = StatusType::FAILURE;
+        }
+        else {
+            team->remove_newest_player();
+            results[i] = StatusType::SUCCESS;
+        }
+    }
+}
+
+
+/* Complexity: time: O(n + k) on average, space: O(n + k_max) for the largest team k_max
+ * Moves all the teams into fresh contiguous storage - the teams in the teams rank tree in its order, then the
+ * empty teams - with the players tree of every team rebuilt in sorted order. teams_hash and teams_rank_tree are
+ * rebuilt for the moved teams, at their ideal sizes. Meant to be run after removing many teams.
+ * Nothing observable changes. If an allocation fails, returns ALLOCATION_ERROR and the teams stay where they were.
+ */
+StatusType olympics_t::compact()
+{
+    int num_teams = teams_arena.getSize();
+    int num_ranked = teams_rank_tree.getSize();
+    Team** old_teams = nullptr;
+    Team** new_teams = nullptr;
+    Pair* keys = nullptr;
+    int* wins = nullptr;
+    ObjectArena<Team> new_arena;
+    int moved = 0;
+    try {
+        flush_pending_wins();
+        old_teams = new Team*[num_teams];
+        new_teams = new Team*[num_teams];
+        keys = new Pair[num_ranked];
+        wins = new int[num_ranked];
+
+        // The teams in the teams rank tree (in order, with their wins - one walk over the tree), then the empty teams:
+        teams_rank_tree.insertKeysAndWinsInorderToArrays(keys, wins);
+        int count = 0;
+        for (RankTree<Pair, Team>::Iterator it = teams_rank_tree.begin(); !it.isEnd(); ++it, count++) {
+            old_teams[count] = it.info();
+        }
+        int max_id = 0;
+        teams_arena.insertObjectsToArray(new_teams);
+        for (int i=0; i<num_teams; i++) {
+            if (new_teams[i]->getSize() == 0) {
+                old_teams[count] = new_teams[i];
+                count++;
+            }
+            if (new_teams[i]->getId() > max_id) {
+                max_id = new_teams[i]->getId();
+            }
+        }
+
+        // Move the teams (new_arena is reserved up front, and moving a team does not allocate):
+        new_arena.reserve(num_teams);
+        for (moved=0; moved<num_teams; moved++) {
+            new_teams[moved] = new_arena.create(std::move(*old_teams[moved]));
+        }
+        for (int i=0; i<num_teams; i++) {
+            new_teams[i]->compact();
+        }
+
+        // Rebuild the index structures for the moved teams:
+        IdTable<Team> new_hash;
+        new_hash.reserve(num_teams, max_id);
+        for (int i=0; i<num_teams; i++) {
+            new_hash.insert(new_teams[i]->getId(), new_teams[i]);
+        }
+        RankTree<Pair, Team> new_rank_tree;
+        new_rank_tree.buildFromSortedArray(keys, new_teams, num_ranked);
+        new_rank_tree.add_wins_to_keys(keys, wins, num_ranked);
+
+        teams_hash.swapTables(new_hash);
+        teams_rank_tree.swapTrees(new_rank_tree);
+        teams_arena.swapArenas(new_arena);
+        team_cache.clear();
+    }
+    catch (const std::bad_alloc&) {
+        // Move the teams back
+        for (int i=0; i<moved; i++) {
+            *old_teams[i] = std::move(*new_teams[i]);
+        }
+        delete[] old_teams;
+        delete[] new_teams;
+        delete[] keys;
+        delete[] wins;
+        return StatusType::ALLOCATION_ERROR;
+    }
+    // new_arena now holds the old (moved-from) teams, and releases them
+    delete[] old_teams;
+    delete[] new_teams;
+    delete[] keys;
+    delete[] wins;
+    return StatusType::SUCCESS;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * The amount of team lookups that were answered by the team cache.
+ */
+long long olympics_t::get_team_cache_hits() const
+{
+    return team_cache.getHits();
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * The amount of team lookups that went to teams_hash.
+ */
+long long olympics_t::get_team_cache_misses() const
+{
+    return team_cache.getMisses();
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Enables (or disables and releases) the ranking snapshot: a frozen, implicitly indexed copy of the teams rank
+ * tree that answers num_wins_for_team and the index lookups of play_tournament with branch-free searches.
+ * It is meant for phases with few updates, and is rebuilt lazily after updates (see use_rank_snapshot).
+ * Nothing observable changes.
+ */
+void olympics_t::set_rank_snapshot(bool enabled)
+{
+    rank_snapshot_enabled = enabled;
+    rank_snapshot_stale_reads = 0;
+    if (!enabled) {
+        rank_snapshot.clear();
+    }
+}
+
+
+/* Complexity: time: O(c log n) worst case for c queries, space: O(1)
+ * Answers num_wins_for_team for all the teamIds: wins[i] and results[i] are the answer and status for teamIds[i]
+ * (wins[i] is 0 unless results[i] is SUCCESS).
+ * NUM_WINS_BATCH_WIDTH lookups are in flight at once, and each stage of a lookup - finding the team in
+ * teams_hash, reading the team, and every level of the descent in teams_rank_tree - prefetches what its next
+ * stage reads, then passes the turn to the next lookup. By the time a lookup gets its turn again its data has
+ * usually arrived, so the cache misses of the batch overlap instead of adding up.
+ * The team cache is bypassed: a large batch would only evict the teams of recent updates.
+ */
+void olympics_t::num_wins_for_teams(const int* teamIds, int count, int* wins, StatusType* results)
+{
+    enum Stage { FREE, FIND_TEAM, READ_TEAM, DESCEND };
+    class Lookup {
+    public:
+        Stage stage;
+        int query;
+        Team* team;
+        RankTree<Pair, Team>::WinsLookup descent;
+    };
+    Lookup lookups[NUM_WINS_BATCH_WIDTH];
+    for (int s=0; s<NUM_WINS_BATCH_WIDTH; s++) {
+        lookups[s].stage = FREE;
+        lookups[s].query = 0;
+    }
+
+    int next_query = 0;
+    int in_flight = 0;
+    for (int s=0; next_query < count || in_flight > 0; s = (s + 1) % NUM_WINS_BATCH_WIDTH) {
+        Lookup& lookup = lookups[s];
+        int q = lookup.query;
+        switch (lookup.stage) {
+            case FREE:
+                if (next_query < count) {
+                    q = next_query;
+                    next_query++;
+                    wins[q] = 0;
+                    if (teamIds[q] <= 0) {
+                        results[q] = StatusType::INVALID_INPUT;
+                        break;
+                    }
+                    teams_hash.prefetch(teamIds[q]);
+                    lookup.query = q;
+                    lookup.stage = FIND_TEAM;
+                    in_flight++;
+                }
+                break;
+            case FIND_TEAM:
+                lookup.team = teams_hash.find(teamIds[q]);
+                if (!lookup.team) {
+                    results[q] = StatusType::FAILURE;
+                    lookup.stage = FREE;
+                    in_flight--;
+                    break;
+                }
+                __builtin_prefetch(lookup.team);
+                lookup.stage = READ_TEAM;
+                break;
+            case READ_TEAM:
+                if (lookup.team->getSize() == 0 || use_rank_snapshot()) {
+                    wins[q] = lookup.team->getSize() == 0 ? lookup.team->get_previous_wins() :
+                              rank_snapshot.get_num_wins(lookup.team->get_pair_key()) +
+                              lookup.team->get_pending_wins();
+                    results[q] = StatusType::SUCCESS;
+                    lookup.stage = FREE;
+                    in_flight--;
+                    break;
+                }
+                teams_rank_tree.startNumWins(lookup.descent, lookup.team->get_pair_key());
+                lookup.stage = DESCEND;
+                break;
+            case DESCEND:
+                if (teams_rank_tree.stepNumWins(lookup.descent)) {
+                    wins[q] = lookup.descent.wins + lookup.team->get_pending_wins();
+                    results[q] = StatusType::SUCCESS;
+                    lookup.stage = FREE;
+                    in_flight--;
+                }
+                break;
+        }
+    }
+}
+
+
+// A team that won matches in play_matches, ordered by its key in the teams rank tree.
+class MatchWinner {
+public:
+    Pair key;
+    Team* team;
+    MatchWinner() : key(), team(nullptr) {};
+    bool operator<(const MatchWinner& other) const {
+        return key < other.key;
+    }
+};
+
+
+/* Complexity: time: O(c + w log w + w log(n/w + 1)) on average for c matches won by w teams, space: O(c)
+ * Plays the matches (teamIds1[i], teamIds2[i]), as play_match would one after the other: winners[i] and results[i]
+ * are the answer and status of match i (winners[i] is 0 unless results[i] is SUCCESS). A match does not change
+ * the strength of the teams, so the matches are independent and are played MATCH_BATCH_BLOCK at a time:
+ * all the team lookups of a block first (prefetching their slots), then all the strengths, and then the winners
+ * are picked with vector compares (see pickWinners).
+ * Instead of a descent of the teams rank tree per win, the teams that won are sorted by their keys, and all the
+ * wins are added on a single descent (see RankTree::add_wins_to_keys). Teams that already had pending wins keep
+ * the new wins pending too.
+ * If the scratch arrays can not be allocated, no match is played and every result is ALLOCATION_ERROR.
+ */
+void olympics_t::play_matches(const int* teamIds1, const int* teamIds2, int count, int* winners,
+                              StatusType* results)
+{
+    MatchWinner* won = nullptr;
+    Pair* keys = nullptr;
+    int* wins = nullptr;
+    try {
+        won = new MatchWinner[count];
+        keys = new Pair[count];
+        wins = new int[count];
+    }
+    catch (const std::bad_alloc&) {
+        delete[] won;
+        delete[] keys;
+        for (int i=0; i<count; i++) {
+            winners[i] = 0;
+            results[i] = StatusType::ALLOCATION_ERROR;
+        }
+        return;
+    }
+
+    int num_won = 0;
+    int matches[MATCH_BATCH_BLOCK];
+    Team* teams1[MATCH_BATCH_BLOCK];
+    Team* teams2[MATCH_BATCH_BLOCK];
+    int ids1[MATCH_BATCH_BLOCK];
+    int ids2[MATCH_BATCH_BLOCK];
+    int strengths1[MATCH_BATCH_BLOCK];
+    int strengths2[MATCH_BATCH_BLOCK];
+    int block_winners[MATCH_BATCH_BLOCK];
+    for (int start=0; start<count; start+=MATCH_BATCH_BLOCK) {
+        int end = start + MATCH_BATCH_BLOCK < count ? start + MATCH_BATCH_BLOCK : count;
+        for (int i=start; i<end; i++) {
+            teams_hash.prefetch(teamIds1[i]);
+            teams_hash.prefetch(teamIds2[i]);
+        }
+
+        // Find the teams, keeping the matches between two existing teams:
+        int num_found = 0;
+        for (int i=start; i<end; i++) {
+            winners[i] = 0;
+            if (teamIds1[i] <= 0 || teamIds2[i] <= 0 || teamIds1[i] == teamIds2[i]) {
+                results[i] = StatusType::INVALID_INPUT;
+                continue;
+            }
+            Team* team1 = teams_hash.find(teamIds1[i]);
+            Team* team2 = teams_hash.find(teamIds2[i]);
+            if (!team1 || !team2) {
+                results[i] = StatusType::FAILURE;
+                continue;
+            }
+            __builtin_prefetch(team1);
+            __builtin_prefetch(team2);
+            matches[num_found] = i;
+            teams1[num_found] = team1;
+            teams2[num_found] = team2;
+            num_found++;
+        }
+
+        // Get the strengths, keeping the matches between two non-empty teams:
+        int num_played = 0;
+        for (int j=0; j<num_found; j++) {
+            if (teams1[j]->isEmpty() || teams2[j]->isEmpty()) {
+                results[matches[j]] = StatusType::FAILURE;
+                continue;
+            }
+            matches[num_played] = matches[j];
+            teams1[num_played] = teams1[j];
+            teams2[num_played] = teams2[j];
+            ids1[num_played] = teamIds1[matches[j]];
+            ids2[num_played] = teamIds2[matches[j]];
+            strengths1[num_played] = teams1[j]->get_strength();
+            strengths2[num_played] = teams2[j]->get_strength();
+            num_played++;
+        }
+
+        pickWinners(strengths1, strengths2, ids1, ids2, num_played, block_winners);
+
+        // Count the wins of every team (in its pending wins), and list the teams that had none:
+        for (int j=0; j<num_played; j++) {
+            Team* winner = block_winners[j] == ids1[j] ? teams1[j] : teams2[j];
+            winners[matches[j]] = block_winners[j];
+            results[matches[j]] = StatusType::SUCCESS;
+            publish(RankEventType::WINS_CHANGED, block_winners[j], 0, 1);
+            if (winner->get_pending_wins() == 0) {
+                won[num_won].key = winner->get_pair_key();
+                won[num_won].team = winner;
+                num_won++;
+            }
+            winner->set_pending_wins(winner->get_pending_wins() + 1);
+        }
+    }
+
+    try {
+        sortKeys(won, num_won);
+        for (int k=0; k<num_won; k++) {
+            keys[k] = won[k].key;
+            wins[k] = won[k].team->get_pending_wins();
+            won[k].team->set_pending_wins(0);
+        }
+        teams_rank_tree.add_wins_to_keys(keys, wins, num_won);
+    }
+    catch (const std::bad_alloc&) {
+        // The winners could not be sorted: add the wins of every team on its own (this does not allocate)
+        for (int k=0; k<num_won; k++) {
+            teams_rank_tree.add_wins_in_range(won[k].key, won[k].key, won[k].team->get_pending_wins());
+            won[k].team->set_pending_wins(0);
+        }
+    }
+    publish_top();
+    delete[] won;
+    delete[] keys;
+    delete[] wins;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Adds an event to the change feed, if it is enabled.
+ */
+void olympics_t::publish(RankEventType type, int team_id, int other_team_id, int value)
+{
+    if (change_feed) {
+        change_feed->push(RankEvent(type, team_id, other_team_id, value));
+    }
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Adds a TOP_CHANGED event to the change feed (if it is enabled) when the highest rank in the teams rank tree is
+ * not the one last published. No match wins are pending while the feed is enabled (see add_pending_win).
+ */
+void olympics_t::publish_top()
+{
+    if (!change_feed) {
+        return;
+    }
+    int top = teams_hash.isEmpty() ? -1 : (teams_rank_tree.isEmpty() ? 0 : teams_rank_tree.get_max_rank());
+    if (top != published_top) {
+        published_top = top;
+        change_feed->push(RankEvent(RankEventType::TOP_CHANGED, 0, 0, top));
+    }
+}
+
+
+/* Complexity: time: O(capacity), space: O(capacity)
+ * Starts publishing the changes to the ranking - re-keyed and removed teams, added wins and changes of the
+ * highest rank - as RankEvents in a lock-free ring buffer of (at least) "capacity" events, which another thread
+ * can read with drain_change_feed while the commands run. The commands never wait for the reader: events that
+ * do not fit are dropped (see get_change_feed_dropped). The first event is the current highest rank.
+ * Replaces (and drops the events of) a feed that was already enabled.
+ * Must not be called while another thread drains the feed.
+ */
+StatusType olympics_t::enable_change_feed(int capacity)
+{
+    if (capacity <= 0) {
+        return StatusType::INVALID_INPUT;
+    }
+    ChangeFeed* new_feed;
+    try {
+        new_feed = new ChangeFeed(capacity);
+    }
+    catch (const std::bad_alloc&) {
+        return StatusType::ALLOCATION_ERROR;
+    }
+    delete change_feed;
+    change_feed = new_feed;
+    // No highest rank is below -1, so the current one (with the wins that were still pending) is published
+    published_top = -2;
+    flush_pending_wins();
+    return StatusType::SUCCESS;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Stops publishing changes and releases the feed (with the events that were not drained).
+ * Must not be called while another thread drains the feed.
+ */
+void olympics_t::disable_change_feed()
+{
+    delete change_feed;
+    change_feed = nullptr;
+}
+
+
+/* Complexity: time: O(max_events), space: O(1)
+ * Moves up to max_events of the oldest events of the change feed to "events", and returns their number (0 if
+ * the feed is disabled). May be called from one other thread while the commands run.
+ */
+int olympics_t::drain_change_feed(RankEvent* events, int max_events)
+{
+    if (!change_feed) {
+        return 0;
+    }
+    return change_feed->drain(events, max_events);
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * The amount of events the change feed dropped because the reader did not keep up.
+ */
+long long olympics_t::get_change_feed_dropped() const
+{
+    if (!change_feed) {
+        return 0;
+    }
+    return change_feed->getDropped();
+}
@@ -16,14 +16,62 @@
 #define OLYMPICSA2_H_
 
 #include "wet2util.h"
-#include "HashTable.h"
+#include "IdTable.h"
 #include "Team.h"
 #include "RankTree.h"
+#include "TeamCache.h"
+#include "ObjectArena.h"
+#include "BlockArena.h"
+#include "RankSnapshot.h"
+#include "ChangeFeed.h"
+
+// A single add_player (is_add) or remove_newest_player command, as used by apply_player_commands.
+class PlayerCommand {
+public:
+    int team_id;
+    int strength;
+    bool is_add;
+    PlayerCommand() : team_id(0), strength(0), is_add(false) {};
+    PlayerCommand(int team_id, int strength, bool is_add) : team_id(team_id), strength(strength), is_add(is_add) {};
+};
 
 class olympics_t {
 private:
-	HashTable<Team> teams_hash;
+    // The arrays of the teams' players pools and undo stacks. Declared before teams_arena, so it outlives it.
+    BlockArena players_arena;
+    // Owns all the teams: teams_hash and teams_rank_tree only point to them.
+    ObjectArena<Team> teams_arena;
+	IdTable<Team> teams_hash;
     RankTree<Pair, Team> teams_rank_tree;
+    // Ids of the teams that may have pending match wins (see flush_pending_wins).
+    Stack<int> pending_win_teams;
+    // The most recently looked up teams, in front of teams_hash (see find_team).
+    TeamCache team_cache;
+    // A frozen copy of teams_rank_tree for read-heavy phases, used when enabled (see use_rank_snapshot).
+    static const int RANK_SNAPSHOT_REBUILD_SHIFT = 3;
+    // The amount of lookups num_wins_for_teams keeps in flight.
+    static const int NUM_WINS_BATCH_WIDTH = 16;
+    // The amount of matches play_matches resolves at a time.
+    static const int MATCH_BATCH_BLOCK = 256;
+    // load_season builds the rosters on all the cores from this amount of players.
+    static const int PARALLEL_LOAD_PLAYERS = 1 << 16;
+    RankSnapshot<Pair> rank_snapshot;
+    bool rank_snapshot_enabled;
+    int rank_snapshot_stale_reads;
+    // The optional feed of ranking changes (see enable_change_feed), nullptr when it is disabled.
+    ChangeFeed* change_feed;
+    int published_top;
+
+    void clear_season();
+    Team* find_team(int teamId);
+    void add_pending_win(Team* team);
+    void flush_pending_wins();
+    int take_team_wins(Team* team);
+    bool use_rank_snapshot();
+    void publish(RankEventType type, int team_id, int other_team_id, int value);
+    void publish_top();
+    void apply_team_commands(const PlayerCommand* commands, const Pair* order, int low, int high,
+                             StatusType* results);
 	
 public:
 	// <DO-NOT-MODIFY> {
@@ -51,6 +99,34 @@ public:
     output_t<int> play_tournament(int lowPower, int highPower);
 	
 	// } </DO-NOT-MODIFY>
+
+    StatusType add_players(int teamId, const int* playerStrengths, int count);
+
+    StatusType load_season(int numTeams, const int* teamIds, const int* rosterSizes, const int* playerStrengths);
+
+    StatusType load_roster_file(const char* path);
+
+    void apply_player_commands(const PlayerCommand* commands, int count, StatusType* results, int num_threads);
+
+    StatusType compact();
+
+    long long get_team_cache_hits() const;
+
+    long long get_team_cache_misses() const;
+
+    void set_rank_snapshot(bool enabled);
+
+    void num_wins_for_teams(const int* teamIds, int count, int* wins, StatusType* results);
+
+    void play_matches(const int* teamIds1, const int* teamIds2, int count, int* winners, StatusType* results);
+
+    StatusType enable_change_feed(int capacity);
+
+    void disable_change_feed();
+
+    int drain_change_feed(RankEvent* events, int max_events);
+
+    long long get_change_feed_dropped() const;
 };
 
 #endif // OLYMPICSA2_H_
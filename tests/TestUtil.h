@@ -0,0 +1,168 @@
+#ifndef DS_WET2_TESTUTIL_H
+#define DS_WET2_TESTUTIL_H
+
+/* Shared fixture of the differential tests in this directory.
+ * Every test runs the same random commands on two instances, "a" and "b". "a" goes through the batch operation
+ * under test, and "b" through the equivalent loop of single calls (or with the optional feature off). Then every
+ * answer and the final state (the wins of every team and the highest rank) are compared.
+ * A test prints the failed checks and exits with 1 if any answer differs (see finishTest).
+ */
+#include "olympics24a2.h"
+#include <cstdio>
+#include <cstdlib>
+
+static const int ROUNDS = 30;
+static const int MAX_PRINTED_FAILURES = 20;
+
+
+/* Complexity: time: O(1), space: O(1)
+ * The amount of failed checks so far.
+ */
+inline int& testFailures()
+{
+    static int failures = 0;
+    return failures;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+inline void expect(bool ok, const char* test, const char* what, int round)
+{
+    if (ok) {
+        return;
+    }
+    int& failures = testFailures();
+    failures++;
+    if (failures <= MAX_PRINTED_FAILURES) {
+        printf("FAIL %s (round %d): %s\n", test, round, what);
+    }
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * Prints the summary of the test, and returns its exit code.
+ */
+inline int finishTest(const char* test)
+{
+    int failures = testFailures();
+    if (failures > 0) {
+        printf("%s: %d checks failed\n", test, failures);
+        return 1;
+    }
+    printf("%s: all tests passed\n", test);
+    return 0;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+inline bool sameOutput(output_t<int> x, output_t<int> y)
+{
+    return x.status() == y.status() && (x.status() != StatusType::SUCCESS || x.ans() == y.ans());
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ * A random team id between 1 and max_id, and now and then an invalid one.
+ */
+inline int randomId(int max_id, int scale)
+{
+    if (rand() % 40 == 0) {
+        return -(rand() % 2);
+    }
+    return scale * (1 + rand() % max_id);
+}
+
+
+/* Complexity: time: O(max_id log n), space: O(1)
+ * Compares the wins of every team (and of some ids that are not teams) and the highest rank.
+ */
+inline void compareState(olympics_t& a, olympics_t& b, int max_id, int scale, const char* test, int round)
+{
+    for (int id = -1; id <= max_id + 1; id++) {
+        int team_id = (id > 0) ? scale * id : id;
+        expect(sameOutput(a.num_wins_for_team(team_id), b.num_wins_for_team(team_id)), test, "num_wins_for_team",
+               round);
+    }
+    expect(sameOutput(a.get_highest_ranked_team(), b.get_highest_ranked_team()), test, "get_highest_ranked_team",
+           round);
+}
+
+
+/* Complexity: time: O(steps * (log n + k)) on average, space: O(1)
+ * Runs "steps" random single commands on both instances, and compares their answers.
+ */
+inline void randomSteps(olympics_t& a, olympics_t& b, int steps, int max_id, int scale, int max_strength,
+                        const char* test, int round)
+{
+    for (int step = 0; step < steps; step++) {
+        int command = rand() % 20;
+        int id1 = randomId(max_id, scale);
+        int id2 = randomId(max_id, scale);
+        int strength = 1 + rand() % max_strength;
+        int low = 1 + rand() % 20;
+        int high = low + rand() % 40;
+        if (command < 2) {
+            expect(a.add_team(id1) == b.add_team(id1), test, "add_team", round);
+        }
+        else if (command < 8) {
+            expect(a.add_player(id1, strength) == b.add_player(id1, strength), test, "add_player", round);
+        }
+        else if (command < 10) {
+            expect(a.remove_newest_player(id1) == b.remove_newest_player(id1), test, "remove_newest_player", round);
+        }
+        else if (command < 15) {
+            expect(sameOutput(a.play_match(id1, id2), b.play_match(id1, id2)), test, "play_match", round);
+        }
+        else if (command < 17) {
+            expect(sameOutput(a.num_wins_for_team(id1), b.num_wins_for_team(id1)), test, "num_wins_for_team",
+                   round);
+        }
+        else if (command == 17 && rand() % 4 == 0) {
+            expect(a.remove_team(id1) == b.remove_team(id1), test, "remove_team", round);
+        }
+        else if (command == 18 && rand() % 4 == 0) {
+            expect(a.unite_teams(id1, id2) == b.unite_teams(id1, id2), test, "unite_teams", round);
+        }
+        else if (command == 19) {
+            expect(sameOutput(a.play_tournament(low, high), b.play_tournament(low, high)), test, "play_tournament",
+                   round);
+        }
+        else {
+            expect(sameOutput(a.get_highest_ranked_team(), b.get_highest_ranked_team()), test,
+                   "get_highest_ranked_team", round);
+        }
+    }
+}
+
+
+/* Complexity: time: O(num_teams) for the season arrays, space: O(num_teams + players)
+ * A random season for load_season: teams 1..num_teams in random order, with rosters of up to max_roster players.
+ * Returns the amount of players. The arrays are allocated here and freed by the caller.
+ */
+inline int randomSeason(int num_teams, int max_roster, int*& team_ids, int*& roster_sizes, int*& strengths)
+{
+    team_ids = new int[num_teams];
+    roster_sizes = new int[num_teams];
+    int total_players = 0;
+    for (int i = 0; i < num_teams; i++) {
+        team_ids[i] = i + 1;
+        roster_sizes[i] = (rand() % 10 == 0) ? 0 : rand() % (max_roster + 1);
+        total_players += roster_sizes[i];
+    }
+    for (int i = num_teams - 1; i > 0; i--) {
+        int j = rand() % (i + 1);
+        int temp = team_ids[i];
+        team_ids[i] = team_ids[j];
+        team_ids[j] = temp;
+    }
+    strengths = new int[total_players];
+    for (int i = 0; i < total_players; i++) {
+        strengths[i] = 1 + rand() % 100;
+    }
+    return total_players;
+}
+
+
+#endif //DS_WET2_TESTUTIL_H
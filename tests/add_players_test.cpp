@@ -0,0 +1,53 @@
+/* Differential test of olympics_t::add_players against a loop of add_player calls.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 -Wall -pthread -I. -o add_players_test tests/add_players_test.cpp \
+ *       olympics24a2.cpp Team.cpp TeamCache.cpp
+ *   ./add_players_test
+ */
+#include "tests/TestUtil.h"
+
+
+static void testAddPlayers()
+{
+    const char* test = "add_players";
+    for (int round = 0; round < ROUNDS; round++) {
+        olympics_t a, b;
+        int max_id = 1 + rand() % 30;
+        for (int batch = 0; batch < 100; batch++) {
+            randomSteps(a, b, 20, max_id, 1, 50, test, round);
+            int team_id = randomId(max_id, 1);
+            int count = (rand() % 5 == 0) ? rand() % 200 : rand() % 20;
+            int* strengths = new int[count + 1];
+            bool valid = true;
+            for (int i = 0; i < count; i++) {
+                strengths[i] = (rand() % 100 == 0) ? 0 : 1 + rand() % 50;
+                valid = valid && strengths[i] > 0;
+            }
+            StatusType result = a.add_players(team_id, strengths, count);
+            if (!valid || team_id <= 0) {
+                // The whole batch is rejected, like its first invalid single call
+                expect(result == StatusType::INVALID_INPUT, test, "invalid batch", round);
+            }
+            else {
+                // An empty batch only tells whether the team exists
+                StatusType expected = (b.num_wins_for_team(team_id).status() == StatusType::SUCCESS) ?
+                                      StatusType::SUCCESS : StatusType::FAILURE;
+                for (int i = 0; i < count; i++) {
+                    expected = b.add_player(team_id, strengths[i]);
+                }
+                expect(result == expected, test, "status", round);
+            }
+            delete[] strengths;
+            compareState(a, b, max_id, 1, test, round);
+        }
+    }
+}
+
+
+int main()
+{
+    srand(2024);
+    testAddPlayers();
+    return finishTest("add_players_test");
+}
@@ -0,0 +1,47 @@
+/* Differential test of olympics_t::apply_player_commands, on 1 to 4 threads, against a loop of add_player and
+ * remove_newest_player calls.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 -Wall -pthread -I. -o apply_player_commands_test tests/apply_player_commands_test.cpp \
+ *       olympics24a2.cpp Team.cpp TeamCache.cpp
+ *   ./apply_player_commands_test
+ */
+#include "tests/TestUtil.h"
+
+
+static void testApplyPlayerCommands()
+{
+    const char* test = "apply_player_commands";
+    for (int round = 0; round < ROUNDS; round++) {
+        olympics_t a, b;
+        int max_id = 1 + rand() % 40;
+        int num_threads = 1 + round % 4;
+        for (int batch = 0; batch < 30; batch++) {
+            randomSteps(a, b, 30, max_id, 1, 50, test, round);
+            int count = rand() % 400;
+            PlayerCommand* commands = new PlayerCommand[count + 1];
+            StatusType* results = new StatusType[count + 1];
+            for (int i = 0; i < count; i++) {
+                int strength = (rand() % 50 == 0) ? 0 : 1 + rand() % 50;
+                commands[i] = PlayerCommand(randomId(max_id + 2, 1), strength, rand() % 3 != 0);
+            }
+            a.apply_player_commands(commands, count, results, num_threads);
+            for (int i = 0; i < count; i++) {
+                StatusType expected = commands[i].is_add ? b.add_player(commands[i].team_id, commands[i].strength) :
+                                      b.remove_newest_player(commands[i].team_id);
+                expect(results[i] == expected, test, "status", round);
+            }
+            delete[] commands;
+            delete[] results;
+            compareState(a, b, max_id + 2, 1, test, round);
+        }
+    }
+}
+
+
+int main()
+{
+    srand(2024);
+    testApplyPlayerCommands();
+    return finishTest("apply_player_commands_test");
+}
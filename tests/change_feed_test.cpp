@@ -0,0 +1,100 @@
+/* Differential test of the change feed: enabling it must not change any answer, and the drained events must
+ * match the wins and the leader of an instance without it.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 -Wall -pthread -I. -o change_feed_test tests/change_feed_test.cpp \
+ *       olympics24a2.cpp Team.cpp TeamCache.cpp
+ *   ./change_feed_test
+ */
+#include "tests/TestUtil.h"
+
+
+/* Complexity: time: O(events), space: O(1)
+ * Drains the change feed, and returns the value of the last TOP_CHANGED event (or "top" if there was none).
+ * Adds the wins of the WINS_CHANGED events to "wins".
+ */
+static int drainFeed(olympics_t& olympics, int top, long long& wins)
+{
+    RankEvent events[64];
+    int count;
+    while ((count = olympics.drain_change_feed(events, 64)) > 0) {
+        for (int i = 0; i < count; i++) {
+            if (events[i].type == RankEventType::TOP_CHANGED) {
+                top = events[i].value;
+            }
+            else if (events[i].type == RankEventType::WINS_CHANGED) {
+                wins += events[i].value;
+            }
+        }
+    }
+    return top;
+}
+
+
+static void testChangeFeed()
+{
+    const char* test = "change_feed";
+    for (int round = 0; round < ROUNDS; round++) {
+        olympics_t a, b;
+        expect(a.enable_change_feed(1 << 16) == StatusType::SUCCESS, test, "enable", round);
+        int max_id = 1 + rand() % 100;
+        int top = -1;
+        long long feed_wins = 0;
+        for (int batch = 0; batch < 20; batch++) {
+            // The feed must not change any answer
+            randomSteps(a, b, 300, max_id, 1, 50, test, round);
+            top = drainFeed(a, top, feed_wins);
+            expect(top == b.get_highest_ranked_team().ans(), test, "last TOP_CHANGED", round);
+
+            // Every win of a batch of matches is published
+            int count = rand() % 200;
+            int* ids1 = new int[count + 1];
+            int* ids2 = new int[count + 1];
+            int* winners = new int[count + 1];
+            StatusType* results = new StatusType[count + 1];
+            for (int i = 0; i < count; i++) {
+                ids1[i] = randomId(max_id, 1);
+                ids2[i] = randomId(max_id, 1);
+            }
+            long long wins_before = feed_wins;
+            a.play_matches(ids1, ids2, count, winners, results);
+            int successes = 0;
+            for (int i = 0; i < count; i++) {
+                b.play_match(ids1[i], ids2[i]);
+                successes += (results[i] == StatusType::SUCCESS);
+            }
+            top = drainFeed(a, top, feed_wins);
+            expect(feed_wins - wins_before == successes, test, "WINS_CHANGED of play_matches", round);
+            expect(top == b.get_highest_ranked_team().ans(), test, "TOP_CHANGED of play_matches", round);
+            delete[] ids1;
+            delete[] ids2;
+            delete[] winners;
+            delete[] results;
+            compareState(a, b, max_id, 1, test, round);
+        }
+        expect(a.get_change_feed_dropped() == 0, test, "dropped events", round);
+    }
+
+    // A single match that changes the leader is published at once, before anything reads the ranking
+    olympics_t olympics;
+    olympics.add_team(1);
+    olympics.add_team(2);
+    olympics.add_player(1, 10);
+    olympics.add_player(2, 10);
+    olympics.enable_change_feed(64);
+    long long wins = 0;
+    int top = drainFeed(olympics, -1, wins);
+    expect(top == 10, test, "first TOP_CHANGED", 0);
+    expect(olympics.play_match(1, 2).ans() == 1, test, "leader match", 0);
+    top = drainFeed(olympics, -1, wins);
+    expect(top == 11, test, "TOP_CHANGED of play_match", 0);
+    expect(wins == 1, test, "WINS_CHANGED of play_match", 0);
+}
+
+
+int main()
+{
+    srand(2024);
+    testChangeFeed();
+    return finishTest("change_feed_test");
+}
@@ -0,0 +1,231 @@
+/* Test of CommandReplay: replays command logs with batched player commands and compares the output with the
+ * output of the serial API, one call per command as in main24a2.cpp.
+ * tests/data/replay_log.expected is the output of main24a2.cpp on tests/data/replay_log.txt.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 -Wall -pthread -I. -o command_replay_test tests/command_replay_test.cpp CommandReplay.cpp \
+ *       olympics24a2.cpp Team.cpp TeamCache.cpp
+ *   ./command_replay_test
+ */
+#include "tests/TestUtil.h"
+#include "CommandReplay.h"
+#include <fstream>
+#include <sstream>
+#include <string>
+
+static const char* const LOG_PATH = "tests/data/replay_log.txt";
+static const char* const EXPECTED_PATH = "tests/data/replay_log.expected";
+static const char* const STATUS_NAMES[] = {"SUCCESS", "ALLOCATION_ERROR", "INVALID_INPUT", "FAILURE"};
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+static void printResult(std::ostream& out, const std::string& op, StatusType res)
+{
+    out << op << ": " << STATUS_NAMES[(int) res] << std::endl;
+}
+
+
+/* Complexity: time: O(1), space: O(1)
+ */
+static void printResult(std::ostream& out, const std::string& op, output_t<int> res)
+{
+    out << op << ": " << STATUS_NAMES[(int) res.status()];
+    if (res.status() == StatusType::SUCCESS) {
+        out << ", " << res.ans();
+    }
+    out << std::endl;
+}
+
+
+/* Complexity: time: the cost of the commands, space: O(1)
+ * Runs the log one command at a time, and writes what main24a2.cpp would write. Returns as CommandReplay::run.
+ */
+static int serialReplay(olympics_t& olympics, std::istream& in, std::ostream& out)
+{
+    int d1 = 0, d2 = 0;
+    std::string op;
+    while (in >> op) {
+        if (op == "add_team") {
+            in >> d1;
+            printResult(out, op, olympics.add_team(d1));
+        }
+        else if (op == "remove_team") {
+            in >> d1;
+            printResult(out, op, olympics.remove_team(d1));
+        }
+        else if (op == "add_player") {
+            in >> d1 >> d2;
+            printResult(out, op, olympics.add_player(d1, d2));
+        }
+        else if (op == "remove_newest_player") {
+            in >> d1;
+            printResult(out, op, olympics.remove_newest_player(d1));
+        }
+        else if (op == "play_match") {
+            in >> d1 >> d2;
+            printResult(out, op, olympics.play_match(d1, d2));
+        }
+        else if (op == "num_wins_for_team") {
+            in >> d1;
+            printResult(out, op, olympics.num_wins_for_team(d1));
+        }
+        else if (op == "get_highest_ranked_team") {
+            printResult(out, op, olympics.get_highest_ranked_team());
+        }
+        else if (op == "unite_teams") {
+            in >> d1 >> d2;
+            printResult(out, op, olympics.unite_teams(d1, d2));
+        }
+        else if (op == "play_tournament") {
+            in >> d1 >> d2;
+            printResult(out, op, olympics.play_tournament(d1, d2));
+        }
+        else {
+            out << "Unknown command: " << op << std::endl;
+            return -1;
+        }
+        if (in.fail()) {
+            out << "Invalid input format" << std::endl;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+
+/* Complexity: time: O(length of the file), space: O(length of the file)
+ */
+static bool readFile(const char* path, std::string& contents)
+{
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    contents = buffer.str();
+    return true;
+}
+
+
+/* Complexity: time: the cost of the commands, space: O(length of the log)
+ * Replays the log with CommandReplay on num_threads threads and with serialReplay, and compares the outputs.
+ */
+static void compareReplays(const std::string& log, int num_threads, const char* test, int round)
+{
+    olympics_t a, b;
+    CommandReplay* replay = new CommandReplay(a, num_threads);
+    std::istringstream in_a(log), in_b(log);
+    std::ostringstream out_a, out_b;
+    int result = replay->run(in_a, out_a);
+    expect(result == serialReplay(b, in_b, out_b), test, "return value", round);
+    expect(out_a.str() == out_b.str(), test, "output", round);
+    delete replay;
+}
+
+
+static void testRecordedLog()
+{
+    const char* test = "recorded log";
+    std::string log, expected;
+    if (!readFile(LOG_PATH, log) || !readFile(EXPECTED_PATH, expected)) {
+        expect(false, test, "can not read tests/data (run from the repository root)", 0);
+        return;
+    }
+    for (int num_threads = 1; num_threads <= 4; num_threads++) {
+        olympics_t olympics;
+        CommandReplay* replay = new CommandReplay(olympics, num_threads);
+        std::istringstream in(log);
+        std::ostringstream out;
+        expect(replay->run(in, out) == 0, test, "return value", num_threads);
+        expect(out.str() == expected, test, "output", num_threads);
+        delete replay;
+        compareReplays(log, num_threads, test, num_threads);
+    }
+}
+
+
+/* Complexity: time: O(length), space: O(length)
+ * A random log of "length" commands on teams 1..max_id. Player commands come in runs of up to max_run, so that
+ * some runs fill more than one batch of CommandReplay.
+ */
+static std::string randomLog(int length, int max_id, int max_run)
+{
+    std::ostringstream log;
+    for (int id = 1; id <= max_id; id += 2) {
+        log << "add_team " << id << "\n";
+    }
+    int written = 0;
+    while (written < length) {
+        int command = rand() % 10;
+        int id1 = randomId(max_id, 1);
+        int id2 = randomId(max_id, 1);
+        if (command < 4) {
+            int run = 1 + rand() % max_run;
+            for (int i = 0; i < run; i++, written++) {
+                if (rand() % 3 != 0) {
+                    int strength = (rand() % 50 == 0) ? 0 : 1 + rand() % 50;
+                    log << "add_player " << randomId(max_id, 1) << " " << strength << "\n";
+                }
+                else {
+                    log << "remove_newest_player " << randomId(max_id, 1) << "\n";
+                }
+            }
+            continue;
+        }
+        if (command == 4) {
+            log << "add_team " << id1 << "\n";
+        }
+        else if (command == 5) {
+            log << ((rand() % 4 == 0) ? "remove_team " : "num_wins_for_team ") << id1 << "\n";
+        }
+        else if (command == 6) {
+            log << ((rand() % 4 == 0) ? "unite_teams " : "play_match ") << id1 << " " << id2 << "\n";
+        }
+        else if (command == 7) {
+            log << "play_match " << id1 << " " << id2 << "\n";
+        }
+        else if (command == 8) {
+            int low = 1 + rand() % 20;
+            log << "play_tournament " << low << " " << low + rand() % 40 << "\n";
+        }
+        else {
+            log << "get_highest_ranked_team\n";
+        }
+        written++;
+    }
+    return log.str();
+}
+
+
+static void testRandomLogs()
+{
+    const char* test = "random logs";
+    for (int round = 0; round < ROUNDS; round++) {
+        // The last rounds have runs longer than a batch
+        bool long_runs = (round >= ROUNDS - 3);
+        std::string log = randomLog(long_runs ? 20000 : 2000, 1 + rand() % 40, long_runs ? 10000 : 50);
+        compareReplays(log, 1 + round % 4, test, round);
+    }
+}
+
+
+static void testBadInput()
+{
+    const char* test = "bad input";
+    // The batch before a bad command is still applied and printed
+    compareReplays("add_team 1\nadd_player 1 5\nremove_newest_player 1\njump 1\nadd_team 2\n", 2, test, 0);
+    compareReplays("add_team 1\nadd_player 1 5\nadd_player 1 x\nadd_team 2\n", 2, test, 1);
+    compareReplays("add_team 1\nplay_match 1\n", 2, test, 2);
+}
+
+
+int main()
+{
+    srand(2024);
+    testRecordedLog();
+    testRandomLogs();
+    testBadInput();
+    return finishTest("command_replay_test");
+}
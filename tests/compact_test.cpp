@@ -0,0 +1,31 @@
+/* Differential test of olympics_t::compact: the answers after compacting must not change.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 -Wall -pthread -I. -o compact_test tests/compact_test.cpp \
+ *       olympics24a2.cpp Team.cpp TeamCache.cpp
+ *   ./compact_test
+ */
+#include "tests/TestUtil.h"
+
+
+static void testCompact()
+{
+    const char* test = "compact";
+    for (int round = 0; round < ROUNDS; round++) {
+        olympics_t a, b;
+        int max_id = 1 + rand() % 80;
+        for (int batch = 0; batch < 10; batch++) {
+            randomSteps(a, b, 300, max_id, 1, 50, test, round);
+            expect(a.compact() == StatusType::SUCCESS, test, "status", round);
+            compareState(a, b, max_id, 1, test, round);
+        }
+    }
+}
+
+
+int main()
+{
+    srand(2024);
+    testCompact();
+    return finishTest("compact_test");
+}
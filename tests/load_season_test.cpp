@@ -0,0 +1,114 @@
+/* Differential test of olympics_t::load_season and load_roster_file against a loop of add_team and
+ * add_player calls.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 -Wall -pthread -I. -o load_season_test tests/load_season_test.cpp \
+ *       olympics24a2.cpp Team.cpp TeamCache.cpp
+ *   ./load_season_test
+ */
+#include "tests/TestUtil.h"
+
+
+/* Complexity: time: O(num_teams + players), space: O(1)
+ * The loop of single calls that load_season replaces.
+ */
+static void loadSeasonOneByOne(olympics_t& olympics, int num_teams, const int* team_ids, const int* roster_sizes,
+                               const int* strengths)
+{
+    int offset = 0;
+    for (int i = 0; i < num_teams; i++) {
+        olympics.add_team(team_ids[i]);
+        for (int j = 0; j < roster_sizes[i]; j++) {
+            olympics.add_player(team_ids[i], strengths[offset + j]);
+        }
+        offset += roster_sizes[i];
+    }
+}
+
+
+static void testLoadSeason()
+{
+    const char* test = "load_season";
+    for (int round = 0; round <= ROUNDS; round++) {
+        olympics_t a, b;
+        // The last round is big enough to build the rosters on all the cores
+        bool big = (round == ROUNDS);
+        int num_teams = big ? 2000 : rand() % 60;
+        int max_roster = big ? 100 : ((rand() % 2 == 0) ? 10 : 60);
+        int* team_ids;
+        int* roster_sizes;
+        int* strengths;
+        randomSeason(num_teams, max_roster, team_ids, roster_sizes, strengths);
+        expect(a.load_season(num_teams, team_ids, roster_sizes, strengths) == StatusType::SUCCESS, test, "status",
+               round);
+        loadSeasonOneByOne(b, num_teams, team_ids, roster_sizes, strengths);
+        compareState(a, b, num_teams, 1, test, round);
+        randomSteps(a, b, 2000, num_teams + 2, 1, 100, test, round);
+        compareState(a, b, num_teams + 2, 1, test, round);
+        // Only an olympics with no teams can be loaded
+        bool has_teams = (b.get_highest_ranked_team().ans() != -1);
+        expect(a.load_season(num_teams, team_ids, roster_sizes, strengths) ==
+               (has_teams ? StatusType::FAILURE : StatusType::SUCCESS), test, "second load", round);
+
+        if (num_teams >= 2) {
+            // A repeated team id loads nothing
+            olympics_t c;
+            team_ids[num_teams - 1] = team_ids[0];
+            expect(c.load_season(num_teams, team_ids, roster_sizes, strengths) == StatusType::INVALID_INPUT, test,
+                   "duplicate id", round);
+            expect(c.get_highest_ranked_team().ans() == -1, test, "duplicate id left teams", round);
+        }
+        delete[] team_ids;
+        delete[] roster_sizes;
+        delete[] strengths;
+    }
+}
+
+
+static void testLoadRosterFile()
+{
+    const char* test = "load_roster_file";
+    const char* path = "load_season_test_roster.txt";
+    for (int round = 0; round < ROUNDS; round++) {
+        int num_teams = rand() % 60;
+        int* team_ids;
+        int* roster_sizes;
+        int* strengths;
+        randomSeason(num_teams, 40, team_ids, roster_sizes, strengths);
+        FILE* file = fopen(path, "w");
+        if (!file) {
+            expect(false, test, "can not write the roster file", round);
+            return;
+        }
+        int offset = 0;
+        for (int i = 0; i < num_teams; i++) {
+            fprintf(file, "%d %d", team_ids[i], roster_sizes[i]);
+            for (int j = 0; j < roster_sizes[i]; j++) {
+                fprintf(file, (j % 8 == 7) ? "\n%d" : " %d", strengths[offset + j]);
+            }
+            fprintf(file, "\n");
+            offset += roster_sizes[i];
+        }
+        fclose(file);
+
+        olympics_t a, b;
+        expect(a.load_roster_file(path) == StatusType::SUCCESS, test, "status", round);
+        b.load_season(num_teams, team_ids, roster_sizes, strengths);
+        compareState(a, b, num_teams, 1, test, round);
+        randomSteps(a, b, 500, num_teams + 2, 1, 100, test, round);
+        compareState(a, b, num_teams + 2, 1, test, round);
+        delete[] team_ids;
+        delete[] roster_sizes;
+        delete[] strengths;
+    }
+    remove(path);
+}
+
+
+int main()
+{
+    srand(2024);
+    testLoadSeason();
+    testLoadRosterFile();
+    return finishTest("load_season_test");
+}
@@ -0,0 +1,51 @@
+/* Differential test of olympics_t::num_wins_for_teams against a loop of num_wins_for_team calls.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 -Wall -pthread -I. -o num_wins_for_teams_test tests/num_wins_for_teams_test.cpp \
+ *       olympics24a2.cpp Team.cpp TeamCache.cpp
+ *   ./num_wins_for_teams_test
+ */
+#include "tests/TestUtil.h"
+
+
+static void testNumWinsForTeams()
+{
+    const char* test = "num_wins_for_teams";
+    for (int round = 0; round < ROUNDS; round++) {
+        olympics_t a, b;
+        int max_id = 1 + rand() % 300;
+        int scale = (round % 2 == 0) ? 1 : 1000;
+        if (round % 3 == 0) {
+            a.set_rank_snapshot(true);
+            b.set_rank_snapshot(true);
+        }
+        for (int batch = 0; batch < 20; batch++) {
+            randomSteps(a, b, 200, max_id, scale, 50, test, round);
+            int count = rand() % 600;
+            int* ids = new int[count + 1];
+            int* wins = new int[count + 1];
+            StatusType* results = new StatusType[count + 1];
+            for (int i = 0; i < count; i++) {
+                ids[i] = randomId(max_id + 5, scale);
+            }
+            a.num_wins_for_teams(ids, count, wins, results);
+            for (int i = 0; i < count; i++) {
+                output_t<int> expected = b.num_wins_for_team(ids[i]);
+                expect(results[i] == expected.status() &&
+                       (results[i] != StatusType::SUCCESS || wins[i] == expected.ans()), test, "answer", round);
+            }
+            delete[] ids;
+            delete[] wins;
+            delete[] results;
+            compareState(a, b, max_id, scale, test, round);
+        }
+    }
+}
+
+
+int main()
+{
+    srand(2024);
+    testNumWinsForTeams();
+    return finishTest("num_wins_for_teams_test");
+}
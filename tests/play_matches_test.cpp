@@ -0,0 +1,55 @@
+/* Differential test of olympics_t::play_matches against a loop of play_match calls.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 -Wall -pthread -I. -o play_matches_test tests/play_matches_test.cpp \
+ *       olympics24a2.cpp Team.cpp TeamCache.cpp
+ *   ./play_matches_test
+ */
+#include "tests/TestUtil.h"
+
+
+static void testPlayMatches()
+{
+    const char* test = "play_matches";
+    for (int round = 0; round < ROUNDS; round++) {
+        olympics_t a, b;
+        // Dense and sparse ids (which also miss the team cache more), low strengths (many ties), and the snapshot
+        int scale = (round % 4 == 1) ? 1000 : 1;
+        int max_strength = (round % 4 == 2) ? 3 : 50;
+        if (round % 4 == 3) {
+            a.set_rank_snapshot(true);
+        }
+        int max_id = 1 + rand() % 500;
+        for (int batch = 0; batch < 20; batch++) {
+            randomSteps(a, b, 300, max_id, scale, max_strength, test, round);
+            int count = rand() % 1500;
+            int* ids1 = new int[count + 1];
+            int* ids2 = new int[count + 1];
+            int* winners = new int[count + 1];
+            StatusType* results = new StatusType[count + 1];
+            for (int i = 0; i < count; i++) {
+                ids1[i] = randomId(max_id + 5, scale);
+                ids2[i] = (rand() % 50 == 0) ? ids1[i] : randomId(max_id + 5, scale);
+            }
+            a.play_matches(ids1, ids2, count, winners, results);
+            for (int i = 0; i < count; i++) {
+                output_t<int> expected = b.play_match(ids1[i], ids2[i]);
+                expect(results[i] == expected.status() &&
+                       (results[i] != StatusType::SUCCESS || winners[i] == expected.ans()), test, "answer", round);
+            }
+            delete[] ids1;
+            delete[] ids2;
+            delete[] winners;
+            delete[] results;
+            compareState(a, b, max_id, scale, test, round);
+        }
+    }
+}
+
+
+int main()
+{
+    srand(2024);
+    testPlayMatches();
+    return finishTest("play_matches_test");
+}
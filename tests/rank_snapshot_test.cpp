@@ -0,0 +1,35 @@
+/* Differential test of the rank snapshot: the answers with set_rank_snapshot(true) must not change.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 -Wall -pthread -I. -o rank_snapshot_test tests/rank_snapshot_test.cpp \
+ *       olympics24a2.cpp Team.cpp TeamCache.cpp
+ *   ./rank_snapshot_test
+ */
+#include "tests/TestUtil.h"
+
+
+static void testRankSnapshot()
+{
+    const char* test = "set_rank_snapshot";
+    for (int round = 0; round < ROUNDS; round++) {
+        olympics_t a, b;
+        a.set_rank_snapshot(true);
+        int max_id = 1 + rand() % 200;
+        for (int batch = 0; batch < 20; batch++) {
+            // Long runs of reads let the snapshot be rebuilt and used
+            randomSteps(a, b, 100, max_id, 1, 50, test, round);
+            compareState(a, b, max_id, 1, test, round);
+            compareState(a, b, max_id, 1, test, round);
+        }
+        a.set_rank_snapshot(false);
+        compareState(a, b, max_id, 1, test, round);
+    }
+}
+
+
+int main()
+{
+    srand(2024);
+    testRankSnapshot();
+    return finishTest("rank_snapshot_test");
+}
@@ -0,0 +1,159 @@
+/* Test of RankTree::add_wins_in_ranges against a brute force count of the wins of every key.
+ * The ends of the ranges are random keys, most of which are not in the tree: below its smallest key, above its
+ * largest one, between two keys with the same strength, or keys that were erased. Empty ranges (min_key >
+ * max_key), zero and negative wins are mixed in.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 -Wall -pthread -I. -o rank_tree_ranges_test tests/rank_tree_ranges_test.cpp \
+ *       olympics24a2.cpp Team.cpp TeamCache.cpp
+ *   ./rank_tree_ranges_test
+ */
+#include "tests/TestUtil.h"
+
+typedef RankTree<Pair, Team> WinsTree;
+
+static const int MAX_STRENGTH = 20;
+
+
+/* The keys that may be in the tree: key i is (strengths[i], i + 1), with few strengths so that many keys tie.
+ * present[i] tells whether key i is in the tree, and wins[i] is its expected amount of wins.
+ */
+class KeySpace {
+public:
+    int size;
+    int* strengths;
+    bool* present;
+    int* wins;
+
+    explicit KeySpace(int size) : size(size), strengths(new int[size + 1]), present(new bool[size + 1]),
+                                  wins(new int[size + 1]) {
+        for (int i = 0; i < size; i++) {
+            strengths[i] = 1 + rand() % MAX_STRENGTH;
+            present[i] = false;
+            wins[i] = 0;
+        }
+    }
+    ~KeySpace() {
+        delete[] strengths;
+        delete[] present;
+        delete[] wins;
+    }
+    KeySpace(const KeySpace& other) = delete;
+    KeySpace& operator=(const KeySpace& other) = delete;
+
+    Pair key(int i) const {
+        return Pair(strengths[i], i + 1);
+    }
+};
+
+
+/* Complexity: time: O(1), space: O(1)
+ * A random end of a range: now and then a key of the key space (in the tree or not), and otherwise a key that is
+ * never in the tree, with a strength from just below the smallest to just above the largest.
+ */
+static Pair randomBound(const KeySpace& space)
+{
+    if (space.size > 0 && rand() % 4 == 0) {
+        return space.key(rand() % space.size);
+    }
+    int strength = rand() % (MAX_STRENGTH + 3);
+    int second = (rand() % 2 == 0) ? space.size + 1 + rand() % 10 : -(rand() % 10);
+    return Pair(strength, second);
+}
+
+
+/* Complexity: time: O(size log n), space: O(1)
+ * Compares the wins of every key in the tree and the highest rank with the brute force.
+ */
+static void compareWins(WinsTree& tree, const KeySpace& space, const char* test, int round)
+{
+    int max_rank = -1;
+    int count = 0;
+    for (int i = 0; i < space.size; i++) {
+        if (!space.present[i]) {
+            continue;
+        }
+        count++;
+        expect(tree.get_num_wins(space.key(i)) == space.wins[i], test, "wins", round);
+        int rank = space.strengths[i] + space.wins[i];
+        max_rank = (count == 1 || rank > max_rank) ? rank : max_rank;
+    }
+    expect(tree.getSize() == count, test, "size", round);
+    if (count > 0) {
+        expect(tree.get_max_rank() == max_rank, test, "max rank", round);
+    }
+}
+
+
+static void testRandomRanges()
+{
+    const char* test = "add_wins_in_ranges";
+    Team info(1);
+    for (int round = 0; round < 10 * ROUNDS; round++) {
+        KeySpace space(rand() % 300);
+        WinsTree tree;
+        for (int batch = 0; batch < 20; batch++) {
+            // Insert and erase some keys, so the ends also hit erased keys
+            for (int step = 0; space.size > 0 && step < 1 + space.size / 4; step++) {
+                int i = rand() % space.size;
+                if (space.present[i] && rand() % 3 == 0) {
+                    expect(tree.erase(space.key(i)), test, "erase", round);
+                    space.present[i] = false;
+                }
+                else if (!space.present[i]) {
+                    expect(tree.insert(space.key(i), &info), test, "insert", round);
+                    space.present[i] = true;
+                    space.wins[i] = 0;
+                }
+            }
+            int count = (rand() % 5 == 0) ? rand() % 3 : rand() % 100;
+            WinsTree::RangeWins* updates = new WinsTree::RangeWins[count + 1];
+            for (int u = 0; u < count; u++) {
+                int wins = (rand() % 10 == 0) ? 0 : rand() % 21 - 5;
+                updates[u] = WinsTree::RangeWins(randomBound(space), randomBound(space), wins);
+                for (int i = 0; i < space.size; i++) {
+                    Pair key = space.key(i);
+                    if (space.present[i] && updates[u].min_key <= key && key <= updates[u].max_key) {
+                        space.wins[i] += wins;
+                    }
+                }
+            }
+            tree.add_wins_in_ranges(updates, count);
+            delete[] updates;
+            compareWins(tree, space, test, round);
+        }
+    }
+}
+
+
+static void testSingleKeyRanges()
+{
+    // Ranges that hold a single key or none, with both ends between the same two neighbouring keys
+    const char* test = "ranges between neighbours";
+    Team info(1);
+    WinsTree tree;
+    for (int id = 1; id <= 9; id++) {
+        tree.insert(Pair(10, 2 * id), &info);
+    }
+    // (10, 2 * id) is followed by (10, 2 * id - 1), which is not in the tree, and then by (10, 2 * id - 2)
+    WinsTree::RangeWins updates[4] = {
+            WinsTree::RangeWins(Pair(10, 9), Pair(10, 7), 100),   // only (10, 8)
+            WinsTree::RangeWins(Pair(10, 5), Pair(10, 5), 1000),  // no key
+            WinsTree::RangeWins(Pair(10, 19), Pair(10, 1), 1),    // every key, ends outside the tree
+            WinsTree::RangeWins(Pair(10, 3), Pair(10, 13), 5),    // min_key > max_key, skipped
+    };
+    tree.add_wins_in_ranges(updates, 4);
+    for (int id = 1; id <= 9; id++) {
+        expect(tree.get_num_wins(Pair(10, 2 * id)) == (id == 4 ? 101 : 1), test, "wins", id);
+    }
+    expect(tree.get_max_rank() == 111, test, "max rank", 0);
+}
+
+
+int main()
+{
+    srand(2024);
+    testRandomRanges();
+    testSingleKeyRanges();
+    return finishTest("rank_tree_ranges_test");
+}
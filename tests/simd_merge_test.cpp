@@ -0,0 +1,177 @@
+/* Test of the AVX2 merge kernel of SimdMerge.h against the scalar mergeDistinctKeys.
+ * The keys of both arrays come from one ascending sequence, split between them in random patterns and in runs
+ * that start and end around the 4-key blocks of the kernel. Many keys share their strength (the first field),
+ * so the order inside a block often depends on the second field only.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 -Wall -pthread -I. -o simd_merge_test tests/simd_merge_test.cpp
+ *   ./simd_merge_test
+ */
+#include "tests/TestUtil.h"
+#include "SimdMerge.h"
+#include <climits>
+
+static const int MAX_SMALL_SIZE = 13;
+
+
+/* Complexity: time: O(size), space: O(1)
+ * Fills "keys" with an ascending sequence: a key keeps the strength of the previous one (with a smaller second
+ * field) with probability tie_percent, and otherwise gets a bigger strength. The first key is "first".
+ */
+static void ascendingKeys(Pair* keys, int size, Pair first, int tie_percent)
+{
+    Pair key = first;
+    for (int i = 0; i < size; i++) {
+        keys[i] = key;
+        if (rand() % 100 < tie_percent && key.second > INT_MIN + 1000) {
+            key.second -= 1 + rand() % 1000;
+        }
+        else {
+            key.first += 1 + rand() % 3;
+            key.second = (rand() % 2 == 0) ? 1 + rand() % 100 : INT_MAX - rand() % 100;
+        }
+    }
+}
+
+
+/* Complexity: time: O(size_a + size_b), space: O(1)
+ * Splits size_a + size_b ascending keys between a and b. With run == 0 every key goes to a random array (as long
+ * as it has room), and otherwise the keys go in alternating runs of "run" keys.
+ */
+static void splitKeys(const Pair* keys, Pair* a, int size_a, Pair* b, int size_b, int run)
+{
+    int ia = 0, ib = 0;
+    bool to_a = (rand() % 2 == 0);
+    for (int i = 0; i < size_a + size_b; i++) {
+        if (run == 0) {
+            to_a = (rand() % (size_a + size_b - i) < size_a - ia);
+        }
+        else if (i % run == 0) {
+            to_a = !to_a;
+        }
+        if (ia == size_a) {
+            to_a = false;
+        }
+        if (ib == size_b) {
+            to_a = true;
+        }
+        if (to_a) {
+            a[ia++] = keys[i];
+        }
+        else {
+            b[ib++] = keys[i];
+        }
+    }
+}
+
+
+/* Complexity: time: O(size_a + size_b), space: O(size_a + size_b)
+ * Merges a and b with the AVX2 kernel, with the dispatching mergeDistinctKeys and with the scalar merge (in both
+ * argument orders), and compares the results.
+ */
+static void compareMerges(Pair* a, int size_a, Pair* b, int size_b, const char* test, int round)
+{
+    int total = size_a + size_b;
+    Pair* expected = new Pair[total + 1];
+    Pair* merged = new Pair[total + 1];
+    int expected_size = mergeDistinctKeys<Pair>(expected, a, size_a, b, size_b);
+    expect(expected_size == total, test, "scalar size", round);
+
+#ifdef SIMD_MERGE_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        for (int order = 0; order < 2; order++) {
+            int size = (order == 0) ? mergeDistinctPairsAVX2(merged, a, size_a, b, size_b) :
+                       mergeDistinctPairsAVX2(merged, b, size_b, a, size_a);
+            bool same = (size == total);
+            for (int i = 0; same && i < total; i++) {
+                same = (merged[i] == expected[i]);
+            }
+            expect(same, test, order == 0 ? "AVX2 merge" : "AVX2 merge, arrays swapped", round);
+        }
+    }
+#endif
+
+    int size = mergeDistinctKeys(merged, a, size_a, b, size_b);
+    bool same = (size == total);
+    for (int i = 0; same && i < total; i++) {
+        same = (merged[i] == expected[i]);
+    }
+    expect(same, test, "mergeDistinctKeys", round);
+    delete[] expected;
+    delete[] merged;
+}
+
+
+/* Complexity: time: O(size_a + size_b), space: O(size_a + size_b)
+ */
+static void mergeRandomSplit(int size_a, int size_b, int run, int tie_percent, const char* test, int round)
+{
+    int total = size_a + size_b;
+    Pair* keys = new Pair[total + 1];
+    Pair* a = new Pair[size_a + 1];
+    Pair* b = new Pair[size_b + 1];
+    Pair first((rand() % 2 == 0) ? 1 : INT_MIN + rand() % 100, INT_MAX - rand() % 100);
+    ascendingKeys(keys, total, first, tie_percent);
+    splitKeys(keys, a, size_a, b, size_b, run);
+    compareMerges(a, size_a, b, size_b, test, round);
+    delete[] keys;
+    delete[] a;
+    delete[] b;
+}
+
+
+static void testSmallSizes()
+{
+    // Every pair of sizes up to a few blocks, so every tail length is merged by the scalar code after the kernel
+    const char* test = "small sizes";
+    for (int size_a = 0; size_a <= MAX_SMALL_SIZE; size_a++) {
+        for (int size_b = 0; size_b <= MAX_SMALL_SIZE; size_b++) {
+            for (int run = 0; run <= 9; run++) {
+                mergeRandomSplit(size_a, size_b, run, 50, test, size_a * 100 + size_b);
+            }
+        }
+    }
+}
+
+
+static void testBlockEdges()
+{
+    // Runs of 3 to 5 keys end just before, at and just after the block edges, and with 90% ties a block edge
+    // usually falls inside a run of equal strengths
+    const char* test = "block edges";
+    for (int round = 0; round < 20 * ROUNDS; round++) {
+        int run = 3 + round % 3;
+        int size_a = 4 * (1 + rand() % 8) + rand() % 3 - 1;
+        int size_b = 4 * (1 + rand() % 8) + rand() % 3 - 1;
+        mergeRandomSplit(size_a, size_b, run, 90, test, round);
+    }
+}
+
+
+static void testLargeArrays()
+{
+    const char* test = "large arrays";
+    for (int round = 0; round < ROUNDS; round++) {
+        int size_a = rand() % 5000;
+        int size_b = (round % 5 == 0) ? rand() % 10 : rand() % 5000;
+        int run = (round % 3 == 0) ? 0 : 1 + rand() % 40;
+        mergeRandomSplit(size_a, size_b, run, rand() % 100, test, round);
+    }
+}
+
+
+int main()
+{
+    srand(2024);
+#ifdef SIMD_MERGE_AVX2
+    if (!__builtin_cpu_supports("avx2")) {
+        printf("simd_merge_test: no AVX2 on this CPU, only the scalar merge is tested\n");
+    }
+#else
+    printf("simd_merge_test: SIMD_MERGE_AVX2 is off, only the scalar merge is tested\n");
+#endif
+    testSmallSizes();
+    testBlockEdges();
+    testLargeArrays();
+    return finishTest("simd_merge_test");
+}